@@ -0,0 +1,111 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "adaptive_deadband.h"
+#include "spacenav_input.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+AdaptiveDeadband::AdaptiveDeadband(){
+    init(AdaptiveDeadbandParams());
+}
+
+void AdaptiveDeadband::init(const AdaptiveDeadbandParams& a_params){
+    m_params = a_params;
+    // Start at the smallest threshold until the noise is measured
+    double sigma = m_params.m_minThreshold / m_params.m_onSigma;
+    for (int i = 0; i < 6; i++){
+        m_mean[i] = 0.0;
+        m_variance[i] = sigma * sigma;
+        m_active[i] = false;
+    }
+}
+
+double AdaptiveDeadband::getThreshold(int a_axis) const{
+    double threshold = m_params.m_onSigma * sqrt(m_variance[a_axis]);
+    return min(max(threshold, m_params.m_minThreshold), m_params.m_maxThreshold);
+}
+
+void AdaptiveDeadband::filter(const double* a_counts, double* a_filtered){
+    if (!m_params.m_enabled){
+        copy(a_counts, a_counts + 6, a_filtered);
+        return;
+    }
+
+    // The device is quiet when no axis is clearly moved. The noise of the axes below their
+    // threshold is learned then, which also lets a noisy unit raise a threshold that started too low
+    bool quiet = true;
+    for (int i = 0; i < 6; i++){
+        if (fabs(a_counts[i] - m_mean[i]) > m_params.m_maxThreshold){
+            quiet = false;
+        }
+    }
+
+    for (int i = 0; i < 6; i++){
+        double onThreshold = getThreshold(i);
+        double offThreshold = onThreshold * m_params.m_offSigma / m_params.m_onSigma;
+        double deviation = a_counts[i] - m_mean[i];
+
+        if (m_active[i]){
+            m_active[i] = fabs(deviation) > offThreshold;
+        }
+        else{
+            m_active[i] = fabs(deviation) > onThreshold;
+        }
+
+        // Start from zero at the release threshold, so the motion does not jump when the axis stops
+        if (m_active[i]){
+            double magnitude = (fabs(deviation) - offThreshold) * SPACENAV_FULL_SCALE / (SPACENAV_FULL_SCALE - offThreshold);
+            a_filtered[i] = deviation > 0.0 ? magnitude : -magnitude;
+        }
+        else{
+            a_filtered[i] = 0.0;
+            if (quiet){
+                m_mean[i] += m_params.m_learningRate * deviation;
+                m_variance[i] = (1.0 - m_params.m_learningRate) * (m_variance[i] + m_params.m_learningRate * deviation * deviation);
+            }
+        }
+    }
+}
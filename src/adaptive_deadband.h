@@ -0,0 +1,80 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef ADAPTIVE_DEADBAND_H
+#define ADAPTIVE_DEADBAND_H
+
+using namespace std;
+
+struct AdaptiveDeadbandParams{
+    bool m_enabled = false;
+    double m_onSigma = 4.0; // An axis starts to move above this many standard deviations of its noise
+    double m_offSigma = 2.0; // and stops below this many
+    double m_minThreshold = 3.0; // [counts] Bounds of the threshold to start the motion
+    double m_maxThreshold = 60.0;
+    double m_learningRate = 0.01; // Weight of a new idle sample in the noise estimate
+};
+
+// Deadband on the device counts with a threshold per axis that follows the noise floor
+// of the unit. The noise of an axis is estimated from its samples below the threshold
+// while the device is not moved, and the hysteresis keeps the axes from toggling at the edge.
+class AdaptiveDeadband{
+    public:
+        AdaptiveDeadband();
+
+        void init(const AdaptiveDeadbandParams& a_params);
+        bool isEnabled() const{ return m_params.m_enabled; }
+
+        // Filters the counts of a motion event [x, y, z, rx, ry, rz]. a_filtered can be a_counts
+        void filter(const double* a_counts, double* a_filtered);
+
+        double getThreshold(int a_axis) const;
+        double getNoiseMean(int a_axis) const{ return m_mean[a_axis]; }
+
+    private:
+        AdaptiveDeadbandParams m_params;
+        double m_mean[6];
+        double m_variance[6];
+        bool m_active[6];
+};
+
+#endif //ADAPTIVE_DEADBAND_H
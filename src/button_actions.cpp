@@ -0,0 +1,189 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "button_actions.h"
+#include <iostream>
+
+using namespace std;
+
+static const char* s_triggerNames[] = {"press", "release", "long press", "chord"};
+static const char* s_actionNames[] = {"none", "next", "previous", "toggle slice", "toggle publish", "toggle mode",
+                                      "cycle slice mode", "toggle crop faces", "undo", "redo", "mark pose", "return to pose"};
+
+ButtonActionMapper::ButtonActionMapper(){
+    for (int i = 0; i < SPACENAV_MAX_BUTTONS; i++){
+        m_press[i] = m_release[i] = m_longPress[i] = ButtonAction::NONE;
+        m_pressTime[i] = 0.0;
+    }
+}
+
+bool ButtonActionMapper::init(const vector<ButtonBinding>& a_bindings, double a_longPressTime, ButtonActionHandler a_handler){
+    m_handler = a_handler;
+    m_longPressTime = a_longPressTime;
+    m_chords.clear();
+    for (int i = 0; i < SPACENAV_MAX_BUTTONS; i++){
+        m_press[i] = m_release[i] = m_longPress[i] = ButtonAction::NONE;
+    }
+
+    bool result = true;
+    for (const ButtonBinding& binding: a_bindings){
+        int count = 0, button = 0;
+        for (int i = 0; i < SPACENAV_MAX_BUTTONS; i++){
+            if (binding.m_buttons & (1u << i)){
+                count++;
+                button = i;
+            }
+        }
+
+        if (binding.m_trigger == ButtonTrigger::CHORD){
+            if (count < 2){
+                cerr << "[ERROR] A chord needs at least two buttons." << endl;
+                result = false;
+                continue;
+            }
+            m_chords[binding.m_buttons] = binding.m_action;
+            continue;
+        }
+
+        if (count != 1){
+            cerr << "[ERROR] The " << s_triggerNames[int(binding.m_trigger)] << " of \"" << getActionName(binding.m_action) << "\" needs exactly one button." << endl;
+            result = false;
+            continue;
+        }
+        ButtonAction* table = binding.m_trigger == ButtonTrigger::PRESS ? m_press :
+                              (binding.m_trigger == ButtonTrigger::RELEASE ? m_release : m_longPress);
+        table[button] = binding.m_action;
+    }
+    return result;
+}
+
+void ButtonActionMapper::handleEvent(const SpaceNavButtonEvent& a_event){
+    if (a_event.m_button < 0 || a_event.m_button >= SPACENAV_MAX_BUTTONS){
+        return;
+    }
+    int button = a_event.m_button;
+    unsigned int bit = 1u << button;
+
+    if (a_event.m_pressed){
+        // A repeated press means that the release was lost. Start over from this press
+        m_pressed |= bit;
+        m_consumed &= ~bit;
+        m_pressTime[button] = a_event.m_time;
+
+        auto chord = m_chords.empty() ? m_chords.end() : m_chords.find(m_pressed);
+        if (chord != m_chords.end()){
+            m_consumed |= m_pressed;
+            m_longPressPending &= ~m_pressed;
+            fire(chord->second, a_event.m_time);
+            return;
+        }
+        if (m_longPress[button] != ButtonAction::NONE){
+            m_longPressPending |= bit;
+        }
+        fire(m_press[button], a_event.m_time);
+    }
+    else{
+        if (!(m_pressed & bit)){
+            return;
+        }
+        m_pressed &= ~bit;
+        m_longPressPending &= ~bit;
+        if (m_consumed & bit){
+            m_consumed &= ~bit;
+            return;
+        }
+        fire(m_release[button], a_event.m_time);
+    }
+}
+
+void ButtonActionMapper::update(double a_time){
+    unsigned int pending = m_longPressPending;
+    for (int i = 0; pending; i++, pending >>= 1){
+        if ((pending & 1u) && a_time - m_pressTime[i] >= m_longPressTime){
+            m_longPressPending &= ~(1u << i);
+            m_consumed |= 1u << i;
+            fire(m_longPress[i], m_pressTime[i] + m_longPressTime);
+        }
+    }
+}
+
+void ButtonActionMapper::fire(ButtonAction a_action, double a_time){
+    if (a_action != ButtonAction::NONE && m_handler){
+        m_handler(a_action, a_time);
+    }
+}
+
+bool ButtonActionMapper::parseTrigger(const string& a_name, ButtonTrigger& a_trigger){
+    for (int i = 0; i < 4; i++){
+        if (a_name == s_triggerNames[i]){
+            a_trigger = ButtonTrigger(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ButtonActionMapper::parseAction(const string& a_name, ButtonAction& a_action){
+    for (int i = 0; i < int(sizeof(s_actionNames) / sizeof(s_actionNames[0])); i++){
+        if (a_name == s_actionNames[i]){
+            a_action = ButtonAction(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* ButtonActionMapper::getActionName(ButtonAction a_action){
+    return s_actionNames[int(a_action)];
+}
+
+vector<ButtonBinding> ButtonActionMapper::getDefaultBindings(bool a_singleButton){
+    vector<ButtonBinding> bindings(2);
+    bindings[0].m_trigger = ButtonTrigger::RELEASE;
+    bindings[0].m_buttons = 1u << 0;
+    bindings[0].m_action = ButtonAction::NEXT_OBJECT;
+    bindings[1].m_trigger = ButtonTrigger::RELEASE;
+    bindings[1].m_buttons = 1u << 1;
+    bindings[1].m_action = a_singleButton ? ButtonAction::TOGGLE_MODE : ButtonAction::PREVIOUS_OBJECT;
+    return bindings;
+}
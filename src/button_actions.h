@@ -0,0 +1,129 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef BUTTON_ACTIONS_H
+#define BUTTON_ACTIONS_H
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "spacenav_input.h"
+
+using namespace std;
+
+enum class ButtonTrigger{
+    PRESS=0,
+    RELEASE=1,
+    LONG_PRESS=2, // Fires while held, the release is then ignored
+    CHORD=3 // Fires when all the buttons are held, their releases are then ignored
+};
+
+enum class ButtonAction{
+    NONE=0,
+    NEXT_OBJECT=1,
+    PREVIOUS_OBJECT=2,
+    TOGGLE_SLICE=3,
+    TOGGLE_PUBLISH=4,
+    TOGGLE_MODE=5, // Slicing and publishing together
+    CYCLE_SLICE_MODE=6,
+    TOGGLE_CROP_FACES=7,
+    UNDO=8, // Pose of the active object before its last manipulation
+    REDO=9,
+    MARK_POSE=10,
+    RETURN_TO_POSE=11 // Back to the marked pose, or to the first one
+};
+
+struct ButtonBinding{
+    ButtonTrigger m_trigger = ButtonTrigger::PRESS;
+    unsigned int m_buttons = 0; // Bit i for button i
+    ButtonAction m_action = ButtonAction::NONE;
+};
+
+// Press or release of a button, stamped when it was received
+struct SpaceNavButtonEvent{
+    int m_button = 0;
+    bool m_pressed = false;
+    double m_time = 0.0;
+};
+
+typedef function<void(ButtonAction a_action, double a_time)> ButtonActionHandler;
+
+// Turns the button edges into actions with lookup tables
+class ButtonActionMapper{
+    public:
+        ButtonActionMapper();
+
+        bool init(const vector<ButtonBinding>& a_bindings, double a_longPressTime, ButtonActionHandler a_handler);
+
+        void handleEvent(const SpaceNavButtonEvent& a_event);
+        // Fires the long presses. Call once per tick after the events
+        void update(double a_time);
+
+        unsigned int getPressedMask(){ return m_pressed; }
+
+        static bool parseTrigger(const string& a_name, ButtonTrigger& a_trigger);
+        static bool parseAction(const string& a_name, ButtonAction& a_action);
+        static const char* getActionName(ButtonAction a_action);
+
+        // Bindings of the previous versions: the first button selects the next object, and the
+        // second one the previous object, or toggles the slicing and the publishing if a_singleButton
+        static vector<ButtonBinding> getDefaultBindings(bool a_singleButton);
+
+    protected:
+        void fire(ButtonAction a_action, double a_time);
+
+        ButtonActionHandler m_handler;
+        double m_longPressTime = 0.8;
+
+        ButtonAction m_press[SPACENAV_MAX_BUTTONS];
+        ButtonAction m_release[SPACENAV_MAX_BUTTONS];
+        ButtonAction m_longPress[SPACENAV_MAX_BUTTONS];
+        unordered_map<unsigned int, ButtonAction> m_chords;
+
+        double m_pressTime[SPACENAV_MAX_BUTTONS];
+        unsigned int m_pressed = 0;
+        unsigned int m_longPressPending = 0; // Held buttons with a long press that did not fire yet
+        unsigned int m_consumed = 0; // Held buttons whose release is ignored
+};
+
+#endif //BUTTON_ACTIONS_H
@@ -182,6 +182,7 @@ bool CameraPanelManager::setVisible(cPanel *a_panel, bool a_visible){
 }
 
 void CameraPanelManager::update(){
+    SPACENAV_TRACE_SCOPE("CameraPanelManager::update");
     CameraPanelMap::const_iterator it = m_cameraPanelMap.begin();
     for (; it != m_cameraPanelMap.end() ; it++){
         for (int j = 0 ; j < it->second.size() ; j++){
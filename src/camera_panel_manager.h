@@ -44,6 +44,7 @@
 
 #include <afFramework.h>
 #include <chai3d.h>
+#include "tracer.h"
 
 using namespace chai3d;
 using namespace ambf;
@@ -0,0 +1,173 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "camera_pose_filter.h"
+
+using namespace std;
+
+CameraPoseFilter::CameraPoseFilter(){
+
+}
+
+void CameraPoseFilter::init(CameraPoseMode a_mode, double a_delay, double a_lead, double a_maxExtrapolation){
+    m_mode = a_mode;
+    m_delay = a_delay;
+    m_lead = a_lead;
+    m_maxExtrapolation = a_maxExtrapolation;
+
+    size_t size = SeqlockRing<CameraPoseSample>::getRequiredSize(SLOT_COUNT);
+    m_memory.assign((size + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+    m_samples.create(m_memory.data(), SLOT_COUNT);
+}
+
+void CameraPoseFilter::record(double a_time, const cVector3d& a_pos, const cMatrix3d& a_rot, bool a_reset){
+    CameraPoseSample sample;
+    sample.m_time = a_time;
+    sample.m_reset = a_reset;
+    cQuaternion quat;
+    quat.fromRotMat(a_rot);
+    for (int i = 0; i < 3; i++){
+        sample.m_pos[i] = a_pos(i);
+    }
+    sample.m_quat[0] = quat.x;
+    sample.m_quat[1] = quat.y;
+    sample.m_quat[2] = quat.z;
+    sample.m_quat[3] = quat.w;
+    m_samples.write(sample);
+}
+
+void CameraPoseFilter::reset(double a_time, const cVector3d& a_pos, const cMatrix3d& a_rot){
+    record(a_time, a_pos, a_rot, true);
+    m_resetTime.store(a_time, memory_order_release);
+}
+
+bool CameraPoseFilter::evaluate(double a_time, cVector3d& a_pos, cMatrix3d& a_rot){
+    if (!m_samples.isValid()){
+        return false;
+    }
+
+    CameraPoseSample latest, previous;
+    uint64_t index;
+    if (!m_samples.readLatest(latest, &index)){
+        return false;
+    }
+    if (latest.m_reset || index == 0 || !m_samples.read(index - 1, previous)){
+        blend(latest, latest, 0.0, a_pos, a_rot);
+        return true;
+    }
+
+    if (m_mode == CameraPoseMode::PREDICT){
+        // Continue the motion of the last step, but not too far
+        double dt = latest.m_time - previous.m_time;
+        double ahead = a_time + m_lead - latest.m_time;
+        ahead = ahead < 0.0 ? 0.0 : (ahead > m_maxExtrapolation ? m_maxExtrapolation : ahead);
+        blend(previous, latest, dt > 0.0 ? 1.0 + ahead / dt : 1.0, a_pos, a_rot);
+        return true;
+    }
+
+    // Walk back to the two samples around the render time
+    double renderTime = a_time - m_delay;
+    CameraPoseSample after = latest;
+    if (renderTime >= after.m_time){
+        blend(after, after, 0.0, a_pos, a_rot);
+        return true;
+    }
+    uint64_t first = index >= SLOT_COUNT ? index - SLOT_COUNT + 1 : 0;
+    for (uint64_t i = index; i > first && !after.m_reset; i--){
+        CameraPoseSample before;
+        if (!m_samples.read(i - 1, before)){
+            break;
+        }
+        if (before.m_time <= renderTime){
+            double dt = after.m_time - before.m_time;
+            blend(before, after, dt > 0.0 ? (renderTime - before.m_time) / dt : 1.0, a_pos, a_rot);
+            return true;
+        }
+        after = before;
+    }
+
+    // Older than the history, or than the latest reset
+    blend(after, after, 0.0, a_pos, a_rot);
+    return true;
+}
+
+void CameraPoseFilter::blend(const CameraPoseSample& a_s0, const CameraPoseSample& a_s1, double a_t, cVector3d& a_pos, cMatrix3d& a_rot){
+    for (int i = 0; i < 3; i++){
+        a_pos(i) = a_s0.m_pos[i] + (a_s1.m_pos[i] - a_s0.m_pos[i]) * a_t;
+    }
+    double q[4];
+    slerp(a_s0.m_quat, a_s1.m_quat, a_t, q);
+    cQuaternion quat(q[3], q[0], q[1], q[2]);
+    quat.toRotMat(a_rot);
+}
+
+// Also valid for a_t outside [0, 1], which extrapolates the rotation
+void CameraPoseFilter::slerp(const double* a_q0, const double* a_q1, double a_t, double* a_result){
+    double q1[4] = {a_q1[0], a_q1[1], a_q1[2], a_q1[3]};
+    double cosAngle = a_q0[0] * q1[0] + a_q0[1] * q1[1] + a_q0[2] * q1[2] + a_q0[3] * q1[3];
+    // Take the shortest path
+    if (cosAngle < 0.0){
+        cosAngle = -cosAngle;
+        for (int i = 0; i < 4; i++){
+            q1[i] = -q1[i];
+        }
+    }
+
+    double w0 = 1.0 - a_t, w1 = a_t;
+    if (cosAngle < 0.9999){
+        double angle = acos(cosAngle);
+        double sinAngle = sin(angle);
+        w0 = sin((1.0 - a_t) * angle) / sinAngle;
+        w1 = sin(a_t * angle) / sinAngle;
+    }
+
+    double norm = 0.0;
+    for (int i = 0; i < 4; i++){
+        a_result[i] = w0 * a_q0[i] + w1 * q1[i];
+        norm += a_result[i] * a_result[i];
+    }
+    norm = sqrt(norm);
+    for (int i = 0; i < 4; i++){
+        a_result[i] /= norm;
+    }
+}
@@ -0,0 +1,102 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef CAMERA_POSE_FILTER_H
+#define CAMERA_POSE_FILTER_H
+
+#include <afFramework.h>
+#include <atomic>
+#include <vector>
+#include "spacenav_state.h"
+
+using namespace chai3d;
+using namespace std;
+
+enum class CameraPoseMode{
+    INTERPOLATE=0, // Render between the two samples around (now - delay)
+    PREDICT=1 // Extrapolate the latest samples to (now + lead)
+};
+
+struct CameraPoseSample{
+    double m_time = 0.0;
+    double m_pos[3] = {0.0, 0.0, 0.0};
+    double m_quat[4] = {0.0, 0.0, 0.0, 1.0}; // [x, y, z, w]
+    bool m_reset = false; // Not blended with the older samples
+};
+
+// Timestamped poses of a camera written in the physics thread and evaluated at render time
+// in the graphics thread
+class CameraPoseFilter{
+    public:
+        CameraPoseFilter();
+
+        void init(CameraPoseMode a_mode, double a_delay, double a_lead, double a_maxExtrapolation);
+
+        // Physics thread
+        void record(double a_time, const cVector3d& a_pos, const cMatrix3d& a_rot, bool a_reset = false);
+        // Starts again from a pose set outside of the control (e.g. with the mouse), without
+        // blending it with the previous poses
+        void reset(double a_time, const cVector3d& a_pos, const cMatrix3d& a_rot);
+
+        // Graphics thread. Time of the latest reset, -1 before any
+        double getResetTime(){ return m_resetTime.load(memory_order_acquire); }
+
+        // Graphics thread. Pose to render at a_time
+        bool evaluate(double a_time, cVector3d& a_pos, cMatrix3d& a_rot);
+
+    protected:
+        static void slerp(const double* a_q0, const double* a_q1, double a_t, double* a_result);
+        static void blend(const CameraPoseSample& a_s0, const CameraPoseSample& a_s1, double a_t, cVector3d& a_pos, cMatrix3d& a_rot);
+
+        CameraPoseMode m_mode = CameraPoseMode::INTERPOLATE;
+        double m_delay = 0.0;
+        double m_lead = 0.0;
+        double m_maxExtrapolation = 0.05;
+
+        atomic<double> m_resetTime{-1.0};
+
+        vector<uint64_t> m_memory;
+        SeqlockRing<CameraPoseSample> m_samples;
+        static const uint32_t SLOT_COUNT = 32;
+};
+
+#endif //CAMERA_POSE_FILTER_H
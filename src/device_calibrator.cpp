@@ -0,0 +1,187 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "device_calibrator.h"
+#include "spacenav_input.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <yaml-cpp/yaml.h>
+
+using namespace std;
+
+static double clampCounts(double a_value){
+    return min(max(a_value, -SPACENAV_FULL_SCALE), SPACENAV_FULL_SCALE);
+}
+
+DeviceCalibrator::DeviceCalibrator(){
+    for (int i = 0; i < 6; i++){
+        m_calibration.m_min[i] = -SPACENAV_FULL_SCALE;
+        m_calibration.m_max[i] = SPACENAV_FULL_SCALE;
+    }
+}
+
+void DeviceCalibrator::setSaturation(double a_saturation){
+    m_saturation = a_saturation;
+}
+
+void DeviceCalibrator::enable(double a_nominalRange, double a_restThreshold, double a_restTime, double a_learningRate){
+    for (int i = 0; i < 6; i++){
+        m_calibration.m_offset[i] = 0.0;
+        m_calibration.m_min[i] = -a_nominalRange;
+        m_calibration.m_max[i] = a_nominalRange;
+    }
+    m_restThreshold = a_restThreshold;
+    m_restTime = a_restTime;
+    m_learningRate = a_learningRate;
+    m_enabled = true;
+}
+
+bool DeviceCalibrator::load(const string& a_filepath, const string& a_device){
+    YAML::Node node;
+    try{
+        node = YAML::LoadFile(a_filepath);
+    }
+    catch (exception& e){
+        cerr << "INFO! No calibration loaded from " << a_filepath << ". Starting from the nominal range" << endl;
+        return false;
+    }
+
+    YAML::Node deviceNode = node[a_device];
+    if (!deviceNode || deviceNode["offset"].size() != 6 || deviceNode["min"].size() != 6 || deviceNode["max"].size() != 6){
+        cerr << "INFO! No calibration of " << a_device << " in " << a_filepath << ". Starting from the nominal range" << endl;
+        return false;
+    }
+
+    for (int i = 0; i < 6; i++){
+        m_calibration.m_offset[i] = deviceNode["offset"][i].as<double>();
+        // Only grow the range, a smaller stored range would saturate the unit early
+        m_calibration.m_min[i] = min(m_calibration.m_min[i], deviceNode["min"][i].as<double>());
+        m_calibration.m_max[i] = max(m_calibration.m_max[i], deviceNode["max"][i].as<double>());
+    }
+    cerr << "INFO! Loaded the calibration of " << a_device << " from " << a_filepath << endl;
+    return true;
+}
+
+bool DeviceCalibrator::save(const string& a_filepath, const string& a_device){
+    // Keep the calibrations of the other units
+    YAML::Node node;
+    try{
+        node = YAML::LoadFile(a_filepath);
+    }
+    catch (exception& e){
+        node = YAML::Node(YAML::NodeType::Map);
+    }
+
+    YAML::Node deviceNode;
+    for (int i = 0; i < 6; i++){
+        deviceNode["offset"].push_back(m_calibration.m_offset[i]);
+        deviceNode["min"].push_back(m_calibration.m_min[i]);
+        deviceNode["max"].push_back(m_calibration.m_max[i]);
+    }
+    node[a_device] = deviceNode;
+
+    ofstream file(a_filepath);
+    if (!file.is_open()){
+        cerr << "ERROR! Could not write the calibration to " << a_filepath << endl;
+        return false;
+    }
+    file << node << endl;
+    return true;
+}
+
+int DeviceCalibrator::process(const double* a_raw, double a_time, double* a_counts){
+    int numClamped = 0;
+    for (int i = 0; i < 6; i++){
+        double raw = a_raw[i];
+        if (fabs(raw) >= m_saturation){
+            raw = raw > 0.0 ? m_saturation : -m_saturation;
+            numClamped++;
+        }
+        m_lastRaw[i] = raw;
+
+        if (!m_enabled){
+            a_counts[i] = clampCounts(raw);
+            continue;
+        }
+
+        // Clamped counts are not trusted to extend the range
+        if (raw == a_raw[i]){
+            m_calibration.m_min[i] = min(m_calibration.m_min[i], raw);
+            m_calibration.m_max[i] = max(m_calibration.m_max[i], raw);
+        }
+
+        // Each side of the zero is mapped on its own, so an offset does not shorten one of them
+        const double& offset = m_calibration.m_offset[i];
+        double value = raw - offset;
+        if (value >= 0.0){
+            value = value / max(m_calibration.m_max[i] - offset, 1.0) * SPACENAV_FULL_SCALE;
+        }
+        else{
+            value = value / max(offset - m_calibration.m_min[i], 1.0) * SPACENAV_FULL_SCALE;
+        }
+        a_counts[i] = clampCounts(value);
+    }
+
+    m_lastEventTime = a_time;
+    m_restHandled = false;
+    return numClamped;
+}
+
+void DeviceCalibrator::update(double a_time){
+    if (!m_enabled || m_restHandled || a_time - m_lastEventTime < m_restTime){
+        return;
+    }
+    m_restHandled = true;
+
+    // spacenavd stops sending events when the puck is released, so the last counts are its rest position
+    for (int i = 0; i < 6; i++){
+        if (fabs(m_lastRaw[i]) > m_restThreshold){
+            return;
+        }
+    }
+    for (int i = 0; i < 6; i++){
+        m_calibration.m_offset[i] += m_learningRate * (m_lastRaw[i] - m_calibration.m_offset[i]);
+    }
+}
@@ -0,0 +1,98 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef DEVICE_CALIBRATOR_H
+#define DEVICE_CALIBRATOR_H
+
+#include <string>
+
+using namespace std;
+
+// Range and zero offset of one unit, in raw device counts [x, y, z, rx, ry, rz]
+struct DeviceCalibration{
+    double m_offset[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    double m_min[6];
+    double m_max[6];
+};
+
+// Clamps every axis of the raw motion events and maps the range of the unit on the full
+// scale. The range grows from a nominal value with the deflections seen, and the zero
+// offset follows the counts the device reports when it comes to rest.
+class DeviceCalibrator{
+    public:
+        DeviceCalibrator();
+
+        // a_saturation: larger counts are treated as invalid and clamped
+        void setSaturation(double a_saturation);
+
+        // a_nominalRange: starting range, smaller than the range of any unit
+        // a_restThreshold: largest counts of a rest position, on every axis
+        // a_restTime: [s] without events after which the device is at rest
+        void enable(double a_nominalRange, double a_restThreshold, double a_restTime, double a_learningRate);
+        bool isEnabled() const{ return m_enabled; }
+
+        // Calibrations of several units are kept in the same file, by device name
+        bool load(const string& a_filepath, const string& a_device);
+        bool save(const string& a_filepath, const string& a_device);
+
+        // Writes the calibrated counts of a motion event. Returns the number of clamped axes
+        int process(const double* a_raw, double a_time, double* a_counts);
+
+        // Detects the rest of the device. Called at every poll
+        void update(double a_time);
+
+        const DeviceCalibration& getCalibration() const{ return m_calibration; }
+
+    private:
+        DeviceCalibration m_calibration;
+        bool m_enabled = false;
+        double m_saturation = 510.0;
+        double m_restThreshold = 40.0;
+        double m_restTime = 0.5;
+        double m_learningRate = 0.1;
+
+        double m_lastRaw[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        double m_lastEventTime = -1.0;
+        bool m_restHandled = true;
+};
+
+#endif //DEVICE_CALIBRATOR_H
@@ -0,0 +1,187 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "metrics.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+MetricsRegistry* MetricsRegistry::getInstance(){
+    static MetricsRegistry s_instance;
+    return &s_instance;
+}
+
+MetricsRegistry::~MetricsRegistry(){
+    stopDump();
+}
+
+MetricEntry* MetricsRegistry::findOrAdd(const string& a_name, const string& a_help, const string& a_labels, MetricType a_type){
+    lock_guard<mutex> lock(m_mutex);
+    for (unique_ptr<MetricEntry>& entry: m_entries){
+        if (entry->m_name == a_name && entry->m_labels == a_labels){
+            if (entry->m_type != a_type){
+                cerr << "ERROR! The metric " << a_name << " is already registered with another type" << endl;
+                return nullptr;
+            }
+            return entry.get();
+        }
+    }
+
+    unique_ptr<MetricEntry> entry(new MetricEntry);
+    entry->m_name = a_name;
+    entry->m_help = a_help;
+    entry->m_labels = a_labels;
+    entry->m_type = a_type;
+    if (a_type == MetricType::COUNTER){
+        entry->m_counter.reset(new MetricCounter);
+    }
+    else{
+        entry->m_gauge.reset(new MetricGauge);
+    }
+    m_entries.push_back(move(entry));
+    return m_entries.back().get();
+}
+
+MetricCounter* MetricsRegistry::getCounter(const string& a_name, const string& a_help, const string& a_labels){
+    MetricEntry* entry = findOrAdd(a_name, a_help, a_labels, MetricType::COUNTER);
+    return entry ? entry->m_counter.get() : nullptr;
+}
+
+MetricGauge* MetricsRegistry::getGauge(const string& a_name, const string& a_help, const string& a_labels){
+    MetricEntry* entry = findOrAdd(a_name, a_help, a_labels, MetricType::GAUGE);
+    return entry ? entry->m_gauge.get() : nullptr;
+}
+
+string MetricsRegistry::format(){
+    lock_guard<mutex> lock(m_mutex);
+    ostringstream out;
+    vector<bool> written(m_entries.size(), false);
+
+    // The samples of a metric have to follow its HELP and TYPE lines
+    for (size_t i = 0; i < m_entries.size(); i++){
+        if (written[i]){
+            continue;
+        }
+        const MetricEntry& first = *m_entries[i];
+        out << "# HELP " << first.m_name << " " << first.m_help << "\n";
+        out << "# TYPE " << first.m_name << (first.m_type == MetricType::COUNTER ? " counter" : " gauge") << "\n";
+        for (size_t j = i; j < m_entries.size(); j++){
+            const MetricEntry& entry = *m_entries[j];
+            if (written[j] || entry.m_name != first.m_name){
+                continue;
+            }
+            out << entry.m_name;
+            if (!entry.m_labels.empty()){
+                out << "{" << entry.m_labels << "}";
+            }
+            if (entry.m_type == MetricType::COUNTER){
+                out << " " << entry.m_counter->get() << "\n";
+            }
+            else{
+                out << " " << entry.m_gauge->get() << "\n";
+            }
+            written[j] = true;
+        }
+    }
+    return out.str();
+}
+
+bool MetricsRegistry::writeFile(const string& a_filepath){
+    string tmpFilepath = a_filepath + ".tmp";
+    {
+        ofstream file(tmpFilepath);
+        if (!file.is_open()){
+            cerr << "ERROR! Could not open the metrics file " << tmpFilepath << endl;
+            return false;
+        }
+        file << format();
+    }
+    if (rename(tmpFilepath.c_str(), a_filepath.c_str()) != 0){
+        cerr << "ERROR! Could not rename the metrics file to " << a_filepath << endl;
+        return false;
+    }
+    return true;
+}
+
+bool MetricsRegistry::startDump(const string& a_filepath, double a_period){
+    if (a_period <= 0.0){
+        cerr << "[ERROR] The metrics dump period has to be positive." << endl;
+        return false;
+    }
+    stopDump();
+    m_dumpFilepath = a_filepath;
+    m_dumpPeriod = a_period;
+    m_dumpRunning = true;
+    m_dumpThread = thread(&MetricsRegistry::dumpLoop, this);
+    return true;
+}
+
+void MetricsRegistry::stopDump(){
+    if (!m_dumpThread.joinable()){
+        return;
+    }
+    {
+        lock_guard<mutex> lock(m_dumpMutex);
+        m_dumpRunning = false;
+    }
+    m_dumpCondition.notify_one();
+    m_dumpThread.join();
+    writeFile(m_dumpFilepath);
+}
+
+void MetricsRegistry::dumpLoop(){
+    const chrono::duration<double> period(m_dumpPeriod);
+    unique_lock<mutex> lock(m_dumpMutex);
+    while (m_dumpRunning){
+        if (m_dumpCondition.wait_for(lock, period, [this]{ return !m_dumpRunning; })){
+            return;
+        }
+        lock.unlock();
+        writeFile(m_dumpFilepath);
+        lock.lock();
+    }
+}
@@ -0,0 +1,127 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+enum class MetricType{
+    COUNTER=0,
+    GAUGE=1
+};
+
+// Monotonic count. Incremented from any thread without locking
+class MetricCounter{
+    public:
+        void increment(uint64_t a_value = 1){ m_value.fetch_add(a_value, memory_order_relaxed); }
+        uint64_t get() const{ return m_value.load(memory_order_relaxed); }
+
+    private:
+        atomic<uint64_t> m_value{0};
+};
+
+// Last value set. Written from any thread without locking
+class MetricGauge{
+    public:
+        void set(double a_value){ m_value.store(a_value, memory_order_relaxed); }
+        double get() const{ return m_value.load(memory_order_relaxed); }
+
+    private:
+        atomic<double> m_value{0.0};
+};
+
+struct MetricEntry{
+    string m_name;
+    string m_help;
+    string m_labels; // e.g. type="motion", empty for none
+    MetricType m_type = MetricType::COUNTER;
+    unique_ptr<MetricCounter> m_counter;
+    unique_ptr<MetricGauge> m_gauge;
+};
+
+// Named counters and gauges of the plugin, written as a Prometheus text exposition.
+// The metrics are registered once and then updated through the returned pointers
+class MetricsRegistry{
+    public:
+        static MetricsRegistry* getInstance();
+        ~MetricsRegistry();
+
+        // Returns the existing metric if the name and the labels are already registered.
+        // The pointer stays valid until the end of the process
+        MetricCounter* getCounter(const string& a_name, const string& a_help, const string& a_labels = "");
+        MetricGauge* getGauge(const string& a_name, const string& a_help, const string& a_labels = "");
+
+        string format();
+
+        // Writes to a temporary file and renames it, so a reader never sees a partial dump
+        bool writeFile(const string& a_filepath);
+
+        // Dumps the metrics every a_period seconds on a background thread, and once more at the stop
+        bool startDump(const string& a_filepath, double a_period);
+        void stopDump();
+
+    private:
+        MetricsRegistry(){}
+        MetricEntry* findOrAdd(const string& a_name, const string& a_help, const string& a_labels, MetricType a_type);
+        void dumpLoop();
+
+        mutex m_mutex;
+        vector<unique_ptr<MetricEntry>> m_entries;
+
+        thread m_dumpThread;
+        mutex m_dumpMutex;
+        condition_variable m_dumpCondition;
+        bool m_dumpRunning = false;
+        string m_dumpFilepath;
+        double m_dumpPeriod = 10.0;
+};
+
+#endif //METRICS_H
@@ -0,0 +1,100 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "motion_sweeper.h"
+
+using namespace std;
+
+// Closest hit that the motion goes into
+struct SweepResultCallback: public btCollisionWorld::ClosestConvexResultCallback{
+    SweepResultCallback(const btVector3& a_from, const btVector3& a_to):
+        btCollisionWorld::ClosestConvexResultCallback(a_from, a_to), m_motion(a_to - a_from){}
+
+    virtual btScalar addSingleResult(btCollisionWorld::LocalConvexResult& a_result, bool a_normalInWorldSpace) override{
+        btVector3 normal = a_normalInWorldSpace ? a_result.m_hitNormalLocal :
+                           a_result.m_hitCollisionObject->getWorldTransform().getBasis() * a_result.m_hitNormalLocal;
+        // Let the object leave a surface it already touches
+        if (normal.dot(m_motion) >= 0.0){
+            return 1.0;
+        }
+        return btCollisionWorld::ClosestConvexResultCallback::addSingleResult(a_result, a_normalInWorldSpace);
+    }
+
+    btVector3 m_motion;
+};
+
+MotionSweeper::MotionSweeper(){
+
+}
+
+void MotionSweeper::init(btCollisionWorld* a_world){
+    m_world = a_world;
+}
+
+double MotionSweeper::sweepSphere(const btVector3& a_from, const btVector3& a_to, double a_radius, double a_margin){
+    double length = (a_to - a_from).length();
+    if (!m_world || length < SIMD_EPSILON){
+        return 1.0;
+    }
+
+    btTransform from(btQuaternion::getIdentity(), a_from);
+    btTransform to(btQuaternion::getIdentity(), a_to);
+    SweepResultCallback callback(a_from, a_to);
+    m_world->convexSweepTest(getSphere(a_radius), from, to, callback);
+    if (!callback.hasHit()){
+        return 1.0;
+    }
+
+    // Stop the margin before the contact
+    m_clampCount++;
+    double fraction = callback.m_closestHitFraction - a_margin / length;
+    return fraction > 0.0 ? fraction : 0.0;
+}
+
+btSphereShape* MotionSweeper::getSphere(double a_radius){
+    unique_ptr<btSphereShape>& sphere = m_spheres[a_radius];
+    if (!sphere){
+        sphere.reset(new btSphereShape(a_radius));
+    }
+    return sphere.get();
+}
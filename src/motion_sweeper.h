@@ -0,0 +1,76 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef MOTION_SWEEPER_H
+#define MOTION_SWEEPER_H
+
+#include <btBulletCollisionCommon.h>
+#include <map>
+#include <memory>
+
+using namespace std;
+
+// Checks the motion of the kinematic objects against the collision world before it is applied
+class MotionSweeper{
+    public:
+        MotionSweeper();
+
+        void init(btCollisionWorld* a_world);
+        bool isEnabled(){ return m_world != nullptr; }
+
+        // Sweeps a sphere from a_from to a_to in the world and returns the fraction of the
+        // motion that is free, [0, 1]. Contacts the sphere is moving away from are ignored
+        double sweepSphere(const btVector3& a_from, const btVector3& a_to, double a_radius, double a_margin);
+
+        unsigned long getClampCount(){ return m_clampCount; }
+
+    protected:
+        btSphereShape* getSphere(double a_radius);
+
+        btCollisionWorld* m_world = nullptr;
+
+        // The shapes are created once per radius
+        map<double, unique_ptr<btSphereShape>> m_spheres;
+        unsigned long m_clampCount = 0;
+};
+
+#endif //MOTION_SWEEPER_H
@@ -0,0 +1,338 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+
+#include "network_input.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cmath>
+#include <errno.h>
+#include <iostream>
+#include <limits>
+#include <netdb.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const unsigned char s_packetMagic[2] = {'S', 'N'};
+
+static void writeUint(unsigned char* a_buffer, uint64_t a_value, int a_size)
+{
+    for (int i = 0; i < a_size; i++){
+        a_buffer[i] = (unsigned char)(a_value >> (8 * i));
+    }
+}
+
+static uint64_t readUint(const unsigned char* a_buffer, int a_size)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < a_size; i++){
+        value |= uint64_t(a_buffer[i]) << (8 * i);
+    }
+    return value;
+}
+
+// [0] magic, [2] version, [3] flags, [4] sequence, [8] send time,
+// [16] axes in counts (6 x int16), [28] buttons
+void encodeSpaceNavPacket(const SpaceNavPacket& a_packet, unsigned char* a_buffer)
+{
+    const SpaceNavInputSample& sample = a_packet.m_sample;
+    a_buffer[0] = s_packetMagic[0];
+    a_buffer[1] = s_packetMagic[1];
+    a_buffer[2] = SPACENAV_PACKET_VERSION;
+    a_buffer[3] = (sample.m_hasMotion ? 1 : 0) | (sample.m_hasButtons ? 2 : 0);
+    writeUint(a_buffer + 4, a_packet.m_sequence, 4);
+    writeUint(a_buffer + 8, a_packet.m_sendTime, 8);
+    for (int i = 0; i < 6; i++){
+        double counts = max(-32767.0, min(32767.0, round(sample.m_axes[i])));
+        writeUint(a_buffer + 16 + 2 * i, uint16_t(int16_t(counts)), 2);
+    }
+    writeUint(a_buffer + 28, sample.m_buttons, 4);
+}
+
+bool decodeSpaceNavPacket(const unsigned char* a_buffer, int a_size, SpaceNavPacket& a_packet)
+{
+    if (a_size != SPACENAV_PACKET_SIZE || a_buffer[0] != s_packetMagic[0] || a_buffer[1] != s_packetMagic[1] ||
+        a_buffer[2] != SPACENAV_PACKET_VERSION){
+        return false;
+    }
+    SpaceNavInputSample& sample = a_packet.m_sample;
+    sample.m_hasMotion = (a_buffer[3] & 1) != 0;
+    sample.m_hasButtons = (a_buffer[3] & 2) != 0;
+    a_packet.m_sequence = uint32_t(readUint(a_buffer + 4, 4));
+    a_packet.m_sendTime = readUint(a_buffer + 8, 8);
+    for (int i = 0; i < 6; i++){
+        sample.m_axes[i] = double(int16_t(uint16_t(readUint(a_buffer + 16 + 2 * i, 2))));
+    }
+    sample.m_buttons = uint32_t(readUint(a_buffer + 28, 4));
+    return true;
+}
+
+bool NetworkInputSender::open(const string& a_host, int a_port)
+{
+    close();
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* address = nullptr;
+    int error = getaddrinfo(a_host.c_str(), to_string(a_port).c_str(), &hints, &address);
+    if (error != 0){
+        cerr << "[ERROR] Could not resolve the receiver " << a_host << ": " << gai_strerror(error) << endl;
+        return false;
+    }
+
+    // Connected, so that the packets are sent without looking up the address again
+    m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_socket < 0 || connect(m_socket, address->ai_addr, address->ai_addrlen) != 0){
+        cerr << "[ERROR] Could not open the socket to " << a_host << ":" << a_port << ": " << strerror(errno) << endl;
+        freeaddrinfo(address);
+        close();
+        return false;
+    }
+    freeaddrinfo(address);
+    m_sequence = 0;
+    return true;
+}
+
+bool NetworkInputSender::send(const SpaceNavInputSample& a_sample)
+{
+    if (m_socket < 0){
+        return false;
+    }
+    SpaceNavPacket packet;
+    packet.m_sequence = m_sequence++;
+    packet.m_sendTime = uint64_t(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+    packet.m_sample = a_sample;
+    unsigned char buffer[SPACENAV_PACKET_SIZE];
+    encodeSpaceNavPacket(packet, buffer);
+
+    // A refused packet (no receiver yet) is only a lost sample
+    return ::send(m_socket, buffer, sizeof(buffer), 0) == SPACENAV_PACKET_SIZE;
+}
+
+void NetworkInputSender::close()
+{
+    if (m_socket >= 0){
+        ::close(m_socket);
+        m_socket = -1;
+    }
+}
+
+bool NetworkInputReceiver::open(const NetworkInputParams& a_params)
+{
+    close();
+    if (a_params.m_maxDelay < a_params.m_minDelay || a_params.m_minDelay < 0.0 || a_params.m_timeout <= 0.0 ||
+        a_params.m_offsetWindow <= 0.0 || a_params.m_queueSize <= 0){
+        cerr << "[ERROR] The delays of the network input have to be ordered, and the timeout, the window and the queue size positive." << endl;
+        return false;
+    }
+    m_params = a_params;
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(uint16_t(m_params.m_port));
+    if (inet_pton(AF_INET, m_params.m_address.c_str(), &address.sin_addr) != 1){
+        cerr << "[ERROR] Invalid address of the network input: " << m_params.m_address << endl;
+        return false;
+    }
+    m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    int reuse = 1;
+    if (m_socket < 0 || setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        bind(m_socket, (sockaddr*)&address, sizeof(address)) != 0){
+        cerr << "[ERROR] Could not bind the network input to " << m_params.m_address << ":" << m_params.m_port << ": " << strerror(errno) << endl;
+        close();
+        return false;
+    }
+
+    m_arrivals.init(m_params.m_queueSize);
+    m_buffer.clear();
+    m_stats = NetworkInputStats();
+    m_overflows = 0;
+    m_invalid = 0;
+    m_hasSequence = false;
+    m_holdSum = 0.0;
+    m_released = 0;
+    m_timedOut = true;
+    m_running = true;
+    m_thread = thread(&NetworkInputReceiver::receiveLoop, this);
+    return true;
+}
+
+void NetworkInputReceiver::close()
+{
+    m_running = false;
+    if (m_thread.joinable()){
+        m_thread.join();
+    }
+    if (m_socket >= 0){
+        ::close(m_socket);
+        m_socket = -1;
+    }
+}
+
+double NetworkInputReceiver::now() const
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Only stamps the arrivals, so that the transit times are not delayed by the consumer
+void NetworkInputReceiver::receiveLoop()
+{
+    pollfd descriptor;
+    descriptor.fd = m_socket;
+    descriptor.events = POLLIN;
+    unsigned char buffer[SPACENAV_PACKET_SIZE + 1];
+    while (m_running.load(memory_order_relaxed)){
+        // Wake up regularly to see the stop
+        if (poll(&descriptor, 1, 100) <= 0){
+            continue;
+        }
+        int size;
+        while ((size = int(recv(m_socket, buffer, sizeof(buffer), MSG_DONTWAIT))) >= 0){
+            Arrival arrival;
+            arrival.m_receiveTime = now();
+            if (!decodeSpaceNavPacket(buffer, size, arrival.m_packet)){
+                m_invalid++;
+            }
+            else if (!m_arrivals.push(arrival)){
+                m_overflows++;
+            }
+        }
+    }
+}
+
+// Sequence and clock bookkeeping of one packet, on the consumer side
+void NetworkInputReceiver::accept(const Arrival& a_arrival)
+{
+    const SpaceNavPacket& packet = a_arrival.m_packet;
+    double sendTime = packet.m_sendTime * 1e-6;
+    double transit = a_arrival.m_receiveTime - sendTime;
+
+    // A sender that comes back after a silence may have restarted its sequence and its clock
+    bool restart = !m_hasSequence || a_arrival.m_receiveTime - m_lastArrivalTime > m_params.m_timeout;
+    if (!restart){
+        int32_t gap = int32_t(packet.m_sequence - m_lastSequence);
+        if (gap <= 0){
+            m_stats.m_late++;
+            return;
+        }
+        m_stats.m_lost += gap - 1;
+
+        // Mean deviation of the transit time between consecutive packets (RFC 3550)
+        m_stats.m_jitter += (fabs(transit - m_lastTransit) - m_stats.m_jitter) / 16.0;
+    }
+    else{
+        m_windowMin[0] = m_windowMin[1] = numeric_limits<double>::infinity();
+        m_windowStart = a_arrival.m_receiveTime;
+        m_stats.m_jitter = 0.0;
+        m_buffer.clear();
+    }
+    m_hasSequence = true;
+    m_lastSequence = packet.m_sequence;
+    m_lastTransit = transit;
+    m_lastArrivalTime = a_arrival.m_receiveTime;
+    m_timedOut = false;
+    m_stats.m_received++;
+
+    // The minimum over the last two windows follows the drift of the clocks
+    if (a_arrival.m_receiveTime - m_windowStart > m_params.m_offsetWindow){
+        m_windowMin[1] = m_windowMin[0];
+        m_windowMin[0] = numeric_limits<double>::infinity();
+        m_windowStart = a_arrival.m_receiveTime;
+    }
+    m_windowMin[0] = min(m_windowMin[0], transit);
+
+    if (int(m_buffer.size()) >= m_params.m_queueSize){
+        m_buffer.pop_front();
+        m_stats.m_overflows++;
+    }
+    m_buffer.push_back(a_arrival);
+}
+
+bool NetworkInputReceiver::pop(SpaceNavInputSample& a_sample)
+{
+    Arrival arrival;
+    while (m_arrivals.pop(arrival)){
+        accept(arrival);
+    }
+
+    double time = now();
+    if (m_buffer.empty()){
+        // Stop the motion and release the buttons if the sender is gone
+        if (!m_timedOut && time - m_lastArrivalTime > m_params.m_timeout){
+            m_timedOut = true;
+            m_stats.m_timeouts++;
+            a_sample = SpaceNavInputSample();
+            a_sample.m_hasMotion = true;
+            a_sample.m_hasButtons = true;
+            return true;
+        }
+        return false;
+    }
+
+    // The packets are in sequence order, so their play out times are increasing
+    double minTransit = min(m_windowMin[0], m_windowMin[1]);
+    m_stats.m_delay = max(m_params.m_minDelay, min(m_params.m_maxDelay, m_params.m_jitterFactor * m_stats.m_jitter));
+    const Arrival& front = m_buffer.front();
+    if (front.m_packet.m_sendTime * 1e-6 + minTransit + m_stats.m_delay > time){
+        return false;
+    }
+    a_sample = front.m_packet.m_sample;
+    m_holdSum += time - front.m_receiveTime;
+    m_released++;
+    m_buffer.pop_front();
+    return true;
+}
+
+NetworkInputStats NetworkInputReceiver::getStats() const
+{
+    NetworkInputStats stats = m_stats;
+    stats.m_invalid = m_invalid.load();
+    stats.m_overflows += m_overflows.load();
+    stats.m_meanHold = m_released > 0 ? m_holdSum / m_released : 0.0;
+    return stats;
+}
@@ -0,0 +1,162 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+#ifndef NETWORK_INPUT_H
+#define NETWORK_INPUT_H
+
+#include <atomic>
+#include <deque>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include "spacenav_input.h"
+#include "spsc_queue.h"
+
+using namespace std;
+
+// Size of a packet on the wire. All the fields are little endian
+#define SPACENAV_PACKET_SIZE 32
+#define SPACENAV_PACKET_VERSION 1
+#define SPACENAV_DEFAULT_PORT 5700
+
+// One sample of the remote device. Every packet carries the full state, so a lost
+// packet is only a missed update
+struct SpaceNavPacket{
+    uint32_t m_sequence = 0;
+    uint64_t m_sendTime = 0; // [us] on the clock of the sender
+    SpaceNavInputSample m_sample;
+};
+
+// Encodes into a buffer of SPACENAV_PACKET_SIZE bytes
+void encodeSpaceNavPacket(const SpaceNavPacket& a_packet, unsigned char* a_buffer);
+// Returns false if the buffer is not a packet of this version
+bool decodeSpaceNavPacket(const unsigned char* a_buffer, int a_size, SpaceNavPacket& a_packet);
+
+// Sends the samples of the local device to a receiver
+class NetworkInputSender{
+    public:
+        ~NetworkInputSender(){ close(); }
+
+        bool open(const string& a_host, int a_port);
+        bool send(const SpaceNavInputSample& a_sample);
+        void close();
+
+        uint32_t getSentCount() const{ return m_sequence; }
+
+    private:
+        int m_socket = -1;
+        uint32_t m_sequence = 0;
+};
+
+struct NetworkInputParams{
+    string m_address = "0.0.0.0"; // Interface the receiver is bound to
+    int m_port = SPACENAV_DEFAULT_PORT;
+    double m_minDelay = 0.0; // [s] Range of the delay added by the jitter buffer
+    double m_maxDelay = 0.02;
+    double m_jitterFactor = 3.0; // Delay in multiples of the measured jitter
+    double m_offsetWindow = 2.0; // [s] Window of the clock offset estimation
+    double m_timeout = 0.1; // [s] without packets before the motion is stopped
+    int m_queueSize = 256;
+};
+
+struct NetworkInputStats{
+    unsigned long m_received = 0;
+    unsigned long m_lost = 0; // Gaps in the sequence numbers
+    unsigned long m_late = 0; // Out of order or duplicated
+    unsigned long m_invalid = 0;
+    unsigned long m_overflows = 0; // Dropped because the consumer was not polling
+    unsigned long m_timeouts = 0;
+    double m_jitter = 0.0; // [s] Mean deviation of the transit time
+    double m_delay = 0.0; // [s] Current delay of the jitter buffer
+    double m_meanHold = 0.0; // [s] Mean time the packets spent in the receiver
+};
+
+// Receives the packets on a thread and releases them through a jitter buffer.
+// The clock offset of the sender is the windowed minimum of the transit times, so
+// the packets are played at their send time plus the fastest transit plus a delay
+// that follows the measured jitter.
+class NetworkInputReceiver{
+    public:
+        ~NetworkInputReceiver(){ close(); }
+
+        bool open(const NetworkInputParams& a_params);
+        void close();
+        bool isOpen() const{ return m_thread.joinable(); }
+
+        // Consumer side. Returns the samples due at the current time, oldest first
+        bool pop(SpaceNavInputSample& a_sample);
+
+        // Consumer side
+        NetworkInputStats getStats() const;
+
+    private:
+        struct Arrival{
+            SpaceNavPacket m_packet;
+            double m_receiveTime = 0.0; // [s] on the local clock
+        };
+
+        void receiveLoop();
+        void accept(const Arrival& a_arrival);
+        double now() const;
+
+        NetworkInputParams m_params;
+        int m_socket = -1;
+        thread m_thread;
+        atomic<bool> m_running{false};
+        SpscQueue<Arrival> m_arrivals;
+        atomic<unsigned long> m_overflows{0};
+        atomic<unsigned long> m_invalid{0};
+
+        // Consumer side
+        deque<Arrival> m_buffer;
+        NetworkInputStats m_stats;
+        bool m_hasSequence = false;
+        uint32_t m_lastSequence = 0;
+        double m_lastTransit = 0.0;
+        double m_windowMin[2]; // Minimum transit of the current and the previous window
+        double m_windowStart = 0.0;
+        double m_lastArrivalTime = 0.0;
+        double m_holdSum = 0.0;
+        unsigned long m_released = 0;
+        bool m_timedOut = true;
+};
+
+#endif //NETWORK_INPUT_H
@@ -0,0 +1,449 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "pose_journal.h"
+#include <cmath>
+#include <cstdlib>
+
+using namespace std;
+
+static uint64_t zigzag(int64_t a_value){
+    return (uint64_t(a_value) << 1) ^ uint64_t(a_value >> 63);
+}
+
+static int64_t unzigzag(uint64_t a_value){
+    return int64_t(a_value >> 1) ^ -int64_t(a_value & 1);
+}
+
+bool PoseJournalPose::operator==(const PoseJournalPose& a_other) const{
+    for (int i = 0; i < 3; i++){
+        if (m_pos[i] != a_other.m_pos[i]){
+            return false;
+        }
+    }
+    for (int i = 0; i < 4; i++){
+        if (m_quat[i] != a_other.m_quat[i]){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PoseJournalPose::isNear(const PoseJournalPose& a_other, int64_t a_tolerance) const{
+    for (int i = 0; i < 3; i++){
+        if (llabs(m_pos[i] - a_other.m_pos[i]) > a_tolerance){
+            return false;
+        }
+    }
+    for (int i = 0; i < 4; i++){
+        if (llabs(int64_t(m_quat[i]) - a_other.m_quat[i]) > a_tolerance){
+            return false;
+        }
+    }
+    return true;
+}
+
+PoseHistory::PoseHistory(uint32_t a_arenaSize, uint32_t a_maxSegments){
+    m_arena.assign(a_arenaSize, 0);
+    m_mask = a_arenaSize - 1;
+    m_segments.resize(a_maxSegments > 0 ? a_maxSegments : 1);
+}
+
+void PoseHistory::putByte(uint8_t a_byte){
+    m_arena[m_writePos & m_mask] = a_byte;
+    m_writePos++;
+}
+
+void PoseHistory::putVarint(uint64_t a_value){
+    while (a_value >= 0x80){
+        putByte(uint8_t(a_value) | 0x80);
+        a_value >>= 7;
+    }
+    putByte(uint8_t(a_value));
+}
+
+uint64_t PoseHistory::getVarint(uint64_t& a_pos) const{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7){
+        uint8_t byte = m_arena[a_pos & m_mask];
+        a_pos++;
+        value |= uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)){
+            break;
+        }
+    }
+    return value;
+}
+
+// Tag byte: 0x80 for a keyframe with the absolute values, otherwise bit i is set for each
+// changed component [x, y, z, qx, qy, qz, qw]. The time follows, absolute or as a delta
+void PoseHistory::writeRecord(const PoseJournalPose& a_pose, uint32_t a_time, bool a_keyframe){
+    if (a_keyframe){
+        putByte(0x80);
+        putVarint(a_time);
+        for (int i = 0; i < 3; i++){
+            putVarint(zigzag(a_pose.m_pos[i]));
+        }
+        for (int i = 0; i < 4; i++){
+            putVarint(zigzag(a_pose.m_quat[i]));
+        }
+    }
+    else{
+        uint8_t mask = 0;
+        for (int i = 0; i < 3; i++){
+            if (a_pose.m_pos[i] != m_last.m_pos[i]){
+                mask |= 1 << i;
+            }
+        }
+        for (int i = 0; i < 4; i++){
+            if (a_pose.m_quat[i] != m_last.m_quat[i]){
+                mask |= 1 << (3 + i);
+            }
+        }
+        putByte(mask);
+        putVarint(a_time - m_lastTime);
+        for (int i = 0; i < 3; i++){
+            if (mask & (1 << i)){
+                putVarint(zigzag(a_pose.m_pos[i] - m_last.m_pos[i]));
+            }
+        }
+        for (int i = 0; i < 4; i++){
+            if (mask & (1 << (3 + i))){
+                putVarint(zigzag(int64_t(a_pose.m_quat[i]) - m_last.m_quat[i]));
+            }
+        }
+    }
+    m_last = a_pose;
+    m_lastTime = a_time;
+}
+
+bool PoseHistory::decodeEnd(const PoseJournalSegment& a_segment, PoseJournalPose& a_pose) const{
+    if (!isValid(a_segment.m_start)){
+        return false;
+    }
+
+    uint64_t pos = a_segment.m_start;
+    while (pos < a_segment.m_end){
+        uint8_t tag = m_arena[pos & m_mask];
+        pos++;
+        getVarint(pos); // Time
+        if (tag & 0x80){
+            for (int i = 0; i < 3; i++){
+                a_pose.m_pos[i] = unzigzag(getVarint(pos));
+            }
+            for (int i = 0; i < 4; i++){
+                a_pose.m_quat[i] = int32_t(unzigzag(getVarint(pos)));
+            }
+        }
+        else{
+            for (int i = 0; i < 3; i++){
+                if (tag & (1 << i)){
+                    a_pose.m_pos[i] += unzigzag(getVarint(pos));
+                }
+            }
+            for (int i = 0; i < 4; i++){
+                if (tag & (1 << (3 + i))){
+                    a_pose.m_quat[i] += int32_t(unzigzag(getVarint(pos)));
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void PoseHistory::dropInvalidSegments(){
+    while (m_segmentBegin < m_segmentEnd && !isValid(m_segments[m_segmentBegin % m_segments.size()].m_start)){
+        m_segmentBegin++;
+    }
+    if (m_cursor < m_segmentBegin){
+        m_cursor = m_segmentBegin;
+    }
+}
+
+void PoseHistory::append(const PoseJournalPose& a_pose, uint32_t a_time, bool a_startSegment){
+    if (!a_startSegment && m_open){
+        writeRecord(a_pose, a_time, false);
+        m_segments[(m_segmentEnd - 1) % m_segments.size()].m_end = m_writePos;
+        return;
+    }
+
+    // A new manipulation replaces the ones that were undone
+    m_segmentEnd = m_cursor;
+    if (m_segmentEnd - m_segmentBegin >= m_segments.size()){
+        m_segmentBegin++;
+    }
+
+    PoseJournalSegment& segment = m_segments[m_segmentEnd % m_segments.size()];
+    segment.m_start = m_writePos;
+    writeRecord(a_pose, a_time, true);
+    segment.m_end = m_writePos;
+    m_segmentEnd++;
+    m_cursor = m_segmentEnd;
+    m_open = true;
+}
+
+void PoseHistory::jump(const PoseJournalPose& a_pose, uint32_t a_time){
+    writeRecord(a_pose, a_time, true);
+    m_open = false;
+}
+
+bool PoseHistory::undo(PoseJournalPose& a_pose, uint32_t a_time){
+    dropInvalidSegments();
+    if (m_cursor <= m_segmentBegin){
+        return false;
+    }
+
+    // The start of a manipulation is its first keyframe
+    PoseJournalSegment segment = m_segments[(m_cursor - 1) % m_segments.size()];
+    segment.m_end = segment.m_start + 1;
+    if (!decodeEnd(segment, a_pose)){
+        return false;
+    }
+    m_cursor--;
+    jump(a_pose, a_time);
+    return true;
+}
+
+bool PoseHistory::redo(PoseJournalPose& a_pose, uint32_t a_time){
+    dropInvalidSegments();
+    if (m_cursor >= m_segmentEnd){
+        return false;
+    }
+
+    if (!decodeEnd(m_segments[m_cursor % m_segments.size()], a_pose)){
+        return false;
+    }
+    m_cursor++;
+    jump(a_pose, a_time);
+    return true;
+}
+
+PoseJournal::PoseJournal(){
+
+}
+
+void PoseJournal::init(uint32_t a_arenaSize, uint32_t a_maxSegments, double a_rate, double a_gap, double a_resolution){
+    // Power of two, so that the positions wrap with a mask
+    m_arenaSize = 1024;
+    while (m_arenaSize < a_arenaSize && m_arenaSize < (1u << 31)){
+        m_arenaSize <<= 1;
+    }
+    m_maxSegments = a_maxSegments;
+    m_period = a_rate > 0.0 ? uint32_t(lround(1000.0 / a_rate)) : 0;
+    m_gap = uint32_t(lround(a_gap * 1000.0));
+    m_resolution = a_resolution;
+    m_histories.clear();
+    m_enabled = true;
+}
+
+PoseHistory* PoseJournal::getHistory(const void* a_key){
+    unique_ptr<PoseHistory>& history = m_histories[a_key];
+    if (!history){
+        history.reset(new PoseHistory(m_arenaSize, m_maxSegments));
+    }
+    return history.get();
+}
+
+uint32_t PoseJournal::toMilliseconds(double a_time) const{
+    return a_time > 0.0 ? uint32_t(llround(a_time * 1000.0)) : 0;
+}
+
+PoseJournalPose PoseJournal::quantize(const cVector3d& a_pos, const cMatrix3d& a_rot, const PoseJournalPose* a_reference) const{
+    PoseJournalPose pose;
+    for (int i = 0; i < 3; i++){
+        pose.m_pos[i] = llround(a_pos(i) / m_resolution);
+    }
+
+    cQuaternion quat;
+    quat.fromRotMat(a_rot);
+    quat.normalize();
+    double q[4] = {quat.x, quat.y, quat.z, quat.w};
+
+    // q and -q are the same rotation. Keep the sign of the previous one so the deltas stay small
+    if (a_reference){
+        double dot = 0.0;
+        for (int i = 0; i < 4; i++){
+            dot += q[i] * a_reference->m_quat[i];
+        }
+        if (dot < 0.0){
+            for (int i = 0; i < 4; i++){
+                q[i] = -q[i];
+            }
+        }
+    }
+    for (int i = 0; i < 4; i++){
+        pose.m_quat[i] = int32_t(lround(q[i] * POSE_JOURNAL_QUAT_SCALE));
+    }
+    return pose;
+}
+
+void PoseJournal::dequantize(const PoseJournalPose& a_pose, cVector3d& a_pos, cMatrix3d& a_rot) const{
+    a_pos.set(a_pose.m_pos[0] * m_resolution, a_pose.m_pos[1] * m_resolution, a_pose.m_pos[2] * m_resolution);
+    cQuaternion quat(a_pose.m_quat[3], a_pose.m_quat[0], a_pose.m_quat[1], a_pose.m_quat[2]);
+    quat.normalize();
+    quat.toRotMat(a_rot);
+}
+
+void PoseJournal::flush(PoseHistory& a_history){
+    if (a_history.m_hasPending){
+        a_history.append(a_history.m_pending, a_history.m_pendingTime, false);
+        a_history.m_hasPending = false;
+    }
+}
+
+void PoseJournal::record(const void* a_key, const cVector3d& a_pos, const cMatrix3d& a_rot, double a_time){
+    if (!m_enabled){
+        return;
+    }
+
+    PoseHistory& history = *getHistory(a_key);
+    uint32_t time = toMilliseconds(a_time);
+    PoseJournalPose pose = quantize(a_pos, a_rot, history.m_hasLatest ? &history.m_latest : nullptr);
+
+    if (!history.m_hasLatest){
+        history.jump(pose, time);
+        history.m_latest = pose;
+        history.m_hasLatest = true;
+        history.m_mark = pose;
+        history.m_lastChangeTime = time;
+        return;
+    }
+
+    // Write the last pose of a motion once it stopped for a record period. A pose set by undo
+    // or redo comes back quantized 1 unit off at times, which must not start a manipulation
+    // and drop the redo. A slow motion still shows once it drifted further from m_latest
+    if (pose.isNear(history.m_latest, 1)){
+        if (history.m_hasPending && time - history.m_lastChangeTime >= m_period){
+            flush(history);
+        }
+        return;
+    }
+
+    bool startSegment = !history.isOpen() || time - history.m_lastChangeTime > m_gap;
+    PoseJournalPose previous = history.m_latest;
+    history.m_latest = pose;
+    history.m_lastChangeTime = time;
+    if (startSegment){
+        // The manipulation starts from the pose the object was left at
+        flush(history);
+        history.append(previous, time, true);
+        history.append(pose, time, false);
+    }
+    else if (time - history.getLastTime() >= m_period){
+        history.append(pose, time, false);
+        history.m_hasPending = false;
+    }
+    else{
+        history.m_pending = pose;
+        history.m_pendingTime = time;
+        history.m_hasPending = true;
+    }
+}
+
+bool PoseJournal::undo(const void* a_key, double a_time, cVector3d& a_pos, cMatrix3d& a_rot){
+    auto it = m_histories.find(a_key);
+    if (it == m_histories.end()){
+        return false;
+    }
+    PoseHistory& history = *it->second;
+    flush(history);
+
+    PoseJournalPose pose;
+    if (!history.undo(pose, toMilliseconds(a_time))){
+        return false;
+    }
+    history.m_latest = pose;
+    dequantize(pose, a_pos, a_rot);
+    return true;
+}
+
+bool PoseJournal::redo(const void* a_key, double a_time, cVector3d& a_pos, cMatrix3d& a_rot){
+    auto it = m_histories.find(a_key);
+    if (it == m_histories.end()){
+        return false;
+    }
+    PoseHistory& history = *it->second;
+    flush(history);
+
+    PoseJournalPose pose;
+    if (!history.redo(pose, toMilliseconds(a_time))){
+        return false;
+    }
+    history.m_latest = pose;
+    dequantize(pose, a_pos, a_rot);
+    return true;
+}
+
+bool PoseJournal::markPose(const void* a_key){
+    auto it = m_histories.find(a_key);
+    if (it == m_histories.end()){
+        return false;
+    }
+    it->second->m_mark = it->second->m_latest;
+    return true;
+}
+
+bool PoseJournal::returnToPose(const void* a_key, double a_time, cVector3d& a_pos, cMatrix3d& a_rot){
+    auto it = m_histories.find(a_key);
+    if (it == m_histories.end() || it->second->m_latest == it->second->m_mark){
+        return false;
+    }
+    PoseHistory& history = *it->second;
+    flush(history);
+
+    uint32_t time = toMilliseconds(a_time);
+    history.append(history.m_latest, time, true);
+    history.append(history.m_mark, time, false);
+    history.close();
+    history.m_latest = history.m_mark;
+    dequantize(history.m_mark, a_pos, a_rot);
+    return true;
+}
+
+size_t PoseJournal::getMemoryUsage() const{
+    size_t size = 0;
+    for (const auto& it: m_histories){
+        size += it.second->getArenaSize() + m_maxSegments * sizeof(PoseJournalSegment);
+    }
+    return size;
+}
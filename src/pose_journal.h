@@ -0,0 +1,168 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef POSE_JOURNAL_H
+#define POSE_JOURNAL_H
+
+#include <afFramework.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace chai3d;
+using namespace std;
+
+// Quantized local pose of an object
+struct PoseJournalPose{
+    int64_t m_pos[3] = {0, 0, 0}; // In units of the position resolution
+    int32_t m_quat[4] = {0, 0, 0, 0}; // [x, y, z, w] scaled by POSE_JOURNAL_QUAT_SCALE
+
+    bool operator==(const PoseJournalPose& a_other) const;
+    bool operator!=(const PoseJournalPose& a_other) const{ return !(*this == a_other); }
+    // True if no component differs by more than a_tolerance units
+    bool isNear(const PoseJournalPose& a_other, int64_t a_tolerance) const;
+};
+
+#define POSE_JOURNAL_QUAT_SCALE 32767.0
+
+// One manipulation, from the keyframe at m_start to the end of its last record at m_end.
+// Both are absolute positions in the arena
+struct PoseJournalSegment{
+    uint64_t m_start = 0;
+    uint64_t m_end = 0;
+};
+
+// Poses of one object in a byte ring of fixed size. A manipulation starts with a keyframe
+// and continues with records of the components that changed, as zigzag varint deltas.
+// The oldest data is overwritten, and the manipulations that lost their start are dropped.
+class PoseHistory{
+    public:
+        PoseHistory(uint32_t a_arenaSize, uint32_t a_maxSegments);
+
+        // Adds the pose to the open manipulation, or starts a new one
+        void append(const PoseJournalPose& a_pose, uint32_t a_time, bool a_startSegment);
+        // Pose set from outside a manipulation (e.g. by undo)
+        void jump(const PoseJournalPose& a_pose, uint32_t a_time);
+
+        bool undo(PoseJournalPose& a_pose, uint32_t a_time);
+        bool redo(PoseJournalPose& a_pose, uint32_t a_time);
+
+        bool isOpen() const{ return m_open; }
+        uint32_t getLastTime() const{ return m_lastTime; }
+        void close(){ m_open = false; }
+        size_t getArenaSize() const{ return m_arena.size(); }
+
+        // Latest pose seen, which may not be written yet because of the recording rate
+        PoseJournalPose m_latest;
+        bool m_hasLatest = false;
+        PoseJournalPose m_pending;
+        uint32_t m_pendingTime = 0;
+        bool m_hasPending = false;
+        uint32_t m_lastChangeTime = 0;
+
+        // Pose to return to. The first pose by default
+        PoseJournalPose m_mark;
+
+    protected:
+        void writeRecord(const PoseJournalPose& a_pose, uint32_t a_time, bool a_keyframe);
+        void putByte(uint8_t a_byte);
+        void putVarint(uint64_t a_value);
+        uint64_t getVarint(uint64_t& a_pos) const;
+        bool isValid(uint64_t a_pos) const{ return a_pos + m_arena.size() >= m_writePos; }
+        bool decodeEnd(const PoseJournalSegment& a_segment, PoseJournalPose& a_pose) const;
+        void dropInvalidSegments();
+
+        vector<uint8_t> m_arena;
+        uint64_t m_mask;
+        uint64_t m_writePos = 0;
+        PoseJournalPose m_last; // Last written, base of the next delta
+        uint32_t m_lastTime = 0;
+        bool m_open = false;
+
+        vector<PoseJournalSegment> m_segments;
+        uint64_t m_segmentBegin = 0; // Absolute indices of the segment ring
+        uint64_t m_segmentEnd = 0;
+        uint64_t m_cursor = 0; // Manipulations before the cursor can be undone, the ones after it redone
+};
+
+// Undo and redo of the manipulations of the controlled objects
+class PoseJournal{
+    public:
+        PoseJournal();
+
+        // a_arenaSize: bytes per object, rounded up to a power of two
+        // a_rate: [Hz] largest rate of the records during a manipulation
+        // a_gap: [s] without change that separates two manipulations
+        void init(uint32_t a_arenaSize, uint32_t a_maxSegments, double a_rate, double a_gap, double a_resolution);
+        bool isEnabled() const{ return m_enabled; }
+
+        // Call after the control of every tick with the local pose of each controlled object
+        void record(const void* a_key, const cVector3d& a_pos, const cMatrix3d& a_rot, double a_time);
+
+        // Pose to set on the object. Returns false if there is nothing to go back or forward to
+        bool undo(const void* a_key, double a_time, cVector3d& a_pos, cMatrix3d& a_rot);
+        bool redo(const void* a_key, double a_time, cVector3d& a_pos, cMatrix3d& a_rot);
+        bool markPose(const void* a_key);
+        // The return is a manipulation itself, so it can be undone
+        bool returnToPose(const void* a_key, double a_time, cVector3d& a_pos, cMatrix3d& a_rot);
+
+        size_t getMemoryUsage() const;
+
+    protected:
+        PoseHistory* getHistory(const void* a_key);
+        PoseJournalPose quantize(const cVector3d& a_pos, const cMatrix3d& a_rot, const PoseJournalPose* a_reference) const;
+        void dequantize(const PoseJournalPose& a_pose, cVector3d& a_pos, cMatrix3d& a_rot) const;
+        uint32_t toMilliseconds(double a_time) const;
+        void flush(PoseHistory& a_history);
+
+        bool m_enabled = false;
+        uint32_t m_arenaSize = 262144;
+        uint32_t m_maxSegments = 1024;
+        uint32_t m_period = 10; // [ms]
+        uint32_t m_gap = 300; // [ms]
+        double m_resolution = 1e-5; // [m]
+
+        // Created the first time an object is recorded
+        map<const void*, unique_ptr<PoseHistory>> m_histories;
+};
+
+#endif //POSE_JOURNAL_H
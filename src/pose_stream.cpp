@@ -0,0 +1,81 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "pose_stream.h"
+
+using namespace std;
+
+PoseStream::PoseStream(){
+
+}
+
+void PoseStream::init(double a_rate, int a_queueSize){
+    m_period = a_rate > 0.0 ? 1.0 / a_rate : 0.0;
+    m_queue.init(a_queueSize);
+    m_lastBatchTime = -1.0;
+    m_enabled = true;
+}
+
+bool PoseStream::record(const PoseStreamSample& a_sample){
+    // Keep the newest samples if the consumer falls behind
+    if (m_queue.pushOverwrite(a_sample)){
+        m_dropped++;
+    }
+
+    if (m_lastBatchTime < 0.0){
+        m_lastBatchTime = a_sample.m_time;
+    }
+    if (a_sample.m_time - m_lastBatchTime < m_period){
+        return false;
+    }
+    m_lastBatchTime = a_sample.m_time;
+    return true;
+}
+
+int PoseStream::drain(PoseStreamSample* a_samples, int a_maxCount){
+    int count = 0;
+    while (count < a_maxCount && m_queue.pop(a_samples[count])){
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,92 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef POSE_STREAM_H
+#define POSE_STREAM_H
+
+#include <atomic>
+#include <stdint.h>
+#include "spsc_queue.h"
+
+using namespace std;
+
+// Number of values of one sample in the published batch:
+// [time, px, py, pz, qx, qy, qz, qw, x, y, z, rx, ry, rz, buttons]
+#define POSE_STREAM_SAMPLE_SIZE 15
+
+// World pose of the active object after the control was applied, and the device command
+// that produced it
+struct PoseStreamSample{
+    double m_time = 0.0;
+    double m_pos[3] = {0.0, 0.0, 0.0};
+    double m_quat[4] = {0.0, 0.0, 0.0, 1.0}; // [x, y, z, w]
+    double m_command[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0}; // Same as the device twist
+    uint32_t m_buttons = 0; // Bit i is set while button i is pressed
+};
+
+// Collects one sample per physics tick and hands them over in batches at a fixed rate
+class PoseStream{
+    public:
+        PoseStream();
+
+        // a_rate: batches per second. a_queueSize: samples buffered between two batches
+        void init(double a_rate, int a_queueSize);
+        bool isEnabled(){ return m_enabled; }
+
+        // Producer side (physics thread). Returns true when a batch is due
+        bool record(const PoseStreamSample& a_sample);
+
+        // Consumer side. Pops at most a_maxCount samples, oldest first
+        int drain(PoseStreamSample* a_samples, int a_maxCount);
+
+        int getCapacity(){ return int(m_queue.capacity()); }
+        unsigned long getDroppedCount(){ return m_dropped.load(); }
+
+    private:
+        SpscQueue<PoseStreamSample> m_queue;
+        bool m_enabled = false;
+        double m_period = 0.0;
+        double m_lastBatchTime = -1.0;
+        atomic<unsigned long> m_dropped{0};
+};
+
+#endif //POSE_STREAM_H
@@ -0,0 +1,146 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "proximity_cache.h"
+
+using namespace std;
+
+// Smallest distance between the probe sphere and the other objects
+struct ClosestDistanceCallback: public btCollisionWorld::ContactResultCallback{
+    ClosestDistanceCallback(const btCollisionObject* a_probe, const btCollisionObject* a_ignore, double a_range):
+        m_probe(a_probe), m_ignore(a_ignore), m_probeRadius(a_range), m_distance(a_range){}
+
+    virtual bool needsCollision(btBroadphaseProxy* a_proxy) const override{
+        const btCollisionObject* object = static_cast<const btCollisionObject*>(a_proxy->m_clientObject);
+        return object != m_ignore && btCollisionWorld::ContactResultCallback::needsCollision(a_proxy);
+    }
+
+    virtual btScalar addSingleResult(btManifoldPoint& a_point,
+                                     const btCollisionObjectWrapper* a_wrapper0, int, int,
+                                     const btCollisionObjectWrapper* a_wrapper1, int, int) override{
+        const btCollisionObject* other = a_wrapper0->getCollisionObject() == m_probe ?
+                                         a_wrapper1->getCollisionObject() : a_wrapper0->getCollisionObject();
+        if (other == m_ignore){
+            return 0.0;
+        }
+        // The distance is negative while the surface is inside the probe
+        double distance = m_probeRadius + a_point.getDistance();
+        if (distance < m_distance){
+            m_distance = distance > 0.0 ? distance : 0.0;
+        }
+        return 0.0;
+    }
+
+    const btCollisionObject* m_probe;
+    const btCollisionObject* m_ignore;
+    double m_probeRadius;
+    double m_distance;
+};
+
+ProximityCache::ProximityCache(){
+
+}
+
+void ProximityCache::init(btCollisionWorld* a_world){
+    m_world = a_world;
+    m_entries.clear();
+}
+
+double ProximityCache::getDistance(const void* a_key, const btVector3& a_point, double a_range, double a_tolerance,
+                                   const btCollisionObject* a_ignore){
+    if (!m_world){
+        return a_range;
+    }
+
+    ProximityEntry& entry = m_entries[a_key];
+    if (entry.m_valid){
+        double motion = (a_point - entry.m_origin).length();
+        if (motion <= a_tolerance){
+            double distance = entry.m_distance - motion;
+            return distance > 0.0 ? distance : 0.0;
+        }
+    }
+
+    if (!m_probeShape || m_probeShape->getRadius() != a_range){
+        m_probeShape.reset(new btSphereShape(a_range));
+        m_probe.setCollisionShape(m_probeShape.get());
+    }
+    m_probe.setWorldTransform(btTransform(btQuaternion::getIdentity(), a_point));
+
+    ClosestDistanceCallback callback(&m_probe, a_ignore, a_range);
+    m_world->contactTest(&m_probe, callback);
+    m_queryCount++;
+
+    entry.m_origin = a_point;
+    entry.m_distance = callback.m_distance;
+    entry.m_valid = true;
+    return entry.m_distance;
+}
+
+double ProximityCache::getRayDistance(const void* a_key, const btVector3& a_origin, const btVector3& a_direction,
+                                      double a_range, double a_tolerance){
+    if (!m_world){
+        return a_range;
+    }
+
+    // A rotation moves the far end of the ray by up to the range times the angle
+    ProximityEntry& entry = m_entries[a_key];
+    if (entry.m_valid){
+        double motion = (a_origin - entry.m_origin).length() + (a_direction - entry.m_direction).length() * a_range;
+        if (motion <= a_tolerance){
+            double distance = entry.m_distance - motion;
+            return distance > 0.0 ? distance : 0.0;
+        }
+    }
+
+    btVector3 to = a_origin + a_direction * a_range;
+    btCollisionWorld::ClosestRayResultCallback callback(a_origin, to);
+    m_world->rayTest(a_origin, to, callback);
+    m_queryCount++;
+
+    entry.m_origin = a_origin;
+    entry.m_direction = a_direction;
+    entry.m_distance = callback.hasHit() ? callback.m_closestHitFraction * a_range : a_range;
+    entry.m_valid = true;
+    return entry.m_distance;
+}
@@ -0,0 +1,90 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef PROXIMITY_CACHE_H
+#define PROXIMITY_CACHE_H
+
+#include <btBulletCollisionCommon.h>
+#include <map>
+#include <memory>
+
+using namespace std;
+
+struct ProximityEntry{
+    btVector3 m_origin;
+    btVector3 m_direction;
+    double m_distance = 0.0;
+    bool m_valid = false;
+};
+
+// Distance from a point to the nearest surface of the collision world. The queries are
+// cached per key and only run again when the point moved more than a tolerance. In between,
+// the cached distance minus the motion is returned, which is never larger than the real one.
+class ProximityCache{
+    public:
+        ProximityCache();
+
+        void init(btCollisionWorld* a_world);
+        bool isEnabled(){ return m_world != nullptr; }
+
+        // Closest surface within a_range, ignoring a_ignore (e.g. the controlled body).
+        // Returns a_range if there is none
+        double getDistance(const void* a_key, const btVector3& a_point, double a_range, double a_tolerance,
+                           const btCollisionObject* a_ignore = nullptr);
+
+        // First surface along a ray within a_range (e.g. what a camera looks at)
+        double getRayDistance(const void* a_key, const btVector3& a_origin, const btVector3& a_direction,
+                              double a_range, double a_tolerance);
+
+        unsigned long getQueryCount(){ return m_queryCount; }
+
+    protected:
+        btCollisionWorld* m_world = nullptr;
+        map<const void*, ProximityEntry> m_entries;
+
+        // Probe of the closest point queries, resized to the range
+        unique_ptr<btSphereShape> m_probeShape;
+        btCollisionObject m_probe;
+        unsigned long m_queryCount = 0;
+};
+
+#endif //PROXIMITY_CACHE_H
@@ -49,14 +49,191 @@ RosInterface::RosInterface(){
 
 void RosInterface::init(string a_namespace){
     m_rosNode = afROSNode::getNode();
+    m_namespace = a_namespace;
+    m_publishedCount = MetricsRegistry::getInstance()->getCounter("spacenav_ros_messages_total", "ROS messages published", "namespace=\"" + a_namespace + "\"");
     m_axisValuePub = m_rosNode->advertise<std_msgs::Float32MultiArray>(a_namespace + "/axis_value", 1);
+    m_axisValueMsg.data.resize(2);
 }
 
 void RosInterface::publishAxisValue(int axis, double value){
-    vector<float> data;
-    data.push_back(axis);
-    data.push_back(value);
-    std_msgs::Float32MultiArray msg;
-    msg.data = data;
-    m_axisValuePub.publish(msg);
+    SPACENAV_TRACE_SCOPE("RosInterface::publishAxisValue");
+    m_axisValueMsg.data[0] = axis;
+    m_axisValueMsg.data[1] = value;
+    m_axisValuePub.publish(m_axisValueMsg);
+    m_publishedCount->increment();
+}
+
+void RosInterface::initDeviceState(int queueSize){
+    m_joyPub = m_rosNode->advertise<sensor_msgs::Joy>(m_namespace + "/joy", queueSize);
+    m_twistPub = m_rosNode->advertise<geometry_msgs::TwistStamped>(m_namespace + "/twist", queueSize);
+    m_joyMsg.header.frame_id = "spacenav";
+    m_joyMsg.axes.resize(6);
+    m_twistMsg.header.frame_id = "spacenav";
+}
+
+// twist: [x, y, z, rx, ry, rz] after scaling and deadband
+void RosInterface::publishDeviceState(const double* twist, const int* buttons, int numButtons){
+    SPACENAV_TRACE_SCOPE("RosInterface::publishDeviceState");
+    ros::Time stamp = ros::Time::now();
+    m_deviceStateSeq++;
+
+    m_joyMsg.header.stamp = stamp;
+    m_joyMsg.header.seq = m_deviceStateSeq;
+    for (int i = 0; i < 6; i++){
+        m_joyMsg.axes[i] = twist[i];
+    }
+    m_joyMsg.buttons.resize(numButtons);
+    for (int i = 0; i < numButtons; i++){
+        m_joyMsg.buttons[i] = buttons[i];
+    }
+
+    m_twistMsg.header.stamp = stamp;
+    m_twistMsg.header.seq = m_deviceStateSeq;
+    m_twistMsg.twist.linear.x = twist[0];
+    m_twistMsg.twist.linear.y = twist[1];
+    m_twistMsg.twist.linear.z = twist[2];
+    m_twistMsg.twist.angular.x = twist[3];
+    m_twistMsg.twist.angular.y = twist[4];
+    m_twistMsg.twist.angular.z = twist[5];
+
+    m_joyPub.publish(m_joyMsg);
+    m_twistPub.publish(m_twistMsg);
+    m_publishedCount->increment(2);
+}
+
+void RosInterface::initSliceImage(){
+    m_sliceImagePub = m_rosNode->advertise<sensor_msgs::Image>(m_namespace + "/slice_image", 1);
+    m_sliceImageMsg.encoding = "mono8";
+    m_sliceImageMsg.is_bigendian = 0;
+}
+
+void RosInterface::publishSliceImage(const vector<uint8_t>& image, int width, int height){
+    SPACENAV_TRACE_SCOPE("RosInterface::publishSliceImage");
+    m_sliceImageMsg.header.stamp = ros::Time::now();
+    m_sliceImageMsg.width = width;
+    m_sliceImageMsg.height = height;
+    m_sliceImageMsg.step = width;
+    m_sliceImageMsg.data.assign(image.begin(), image.end());
+    m_sliceImagePub.publish(m_sliceImageMsg);
+    m_publishedCount->increment();
+}
+
+void RosInterface::initStatistics(){
+    m_statisticsPub = m_rosNode->advertise<std_msgs::Int64MultiArray>(m_namespace + "/statistics", 1);
+    // [min, max, count, count above threshold, histogram (256 bins)]
+    m_statisticsMsg.data.resize(4 + 256);
+}
+
+void RosInterface::publishStatistics(int min, int max, long long count, long long countAboveThreshold, const long long* histogram){
+    SPACENAV_TRACE_SCOPE("RosInterface::publishStatistics");
+    m_statisticsMsg.data[0] = min;
+    m_statisticsMsg.data[1] = max;
+    m_statisticsMsg.data[2] = count;
+    m_statisticsMsg.data[3] = countAboveThreshold;
+    for (int i = 0; i < 256; i++){
+        m_statisticsMsg.data[4 + i] = histogram[i];
+    }
+    m_statisticsPub.publish(m_statisticsMsg);
+    m_publishedCount->increment();
+}
+
+void RosInterface::initPoseStream(int maxSamples){
+    m_poseStreamPub = m_rosNode->advertise<std_msgs::Float64MultiArray>(m_namespace + "/pose_stream", 10);
+    m_poseBatch.resize(maxSamples);
+    // One row per sample: [time, px, py, pz, qx, qy, qz, qw, x, y, z, rx, ry, rz, buttons]
+    m_poseStreamMsg.layout.dim.resize(2);
+    m_poseStreamMsg.layout.dim[0].label = "samples";
+    m_poseStreamMsg.layout.dim[1].label = "fields";
+    m_poseStreamMsg.layout.dim[1].size = POSE_STREAM_SAMPLE_SIZE;
+    m_poseStreamMsg.layout.dim[1].stride = POSE_STREAM_SAMPLE_SIZE;
+    m_poseStreamMsg.data.reserve(maxSamples * POSE_STREAM_SAMPLE_SIZE);
+}
+
+void RosInterface::publishPoseBatch(PoseStream* stream){
+    SPACENAV_TRACE_SCOPE("RosInterface::publishPoseBatch");
+    int count = stream->drain(m_poseBatch.data(), int(m_poseBatch.size()));
+    if (count == 0){
+        return;
+    }
+
+    // The data never grows past the reserved size, so this does not allocate
+    m_poseStreamMsg.data.resize(count * POSE_STREAM_SAMPLE_SIZE);
+    m_poseStreamMsg.layout.dim[0].size = count;
+    m_poseStreamMsg.layout.dim[0].stride = count * POSE_STREAM_SAMPLE_SIZE;
+    double* row = m_poseStreamMsg.data.data();
+    for (int i = 0; i < count; i++){
+        const PoseStreamSample& sample = m_poseBatch[i];
+        row[0] = sample.m_time;
+        for (int j = 0; j < 3; j++){
+            row[1 + j] = sample.m_pos[j];
+        }
+        for (int j = 0; j < 4; j++){
+            row[4 + j] = sample.m_quat[j];
+        }
+        for (int j = 0; j < 6; j++){
+            row[8 + j] = sample.m_command[j];
+        }
+        row[14] = sample.m_buttons;
+        row += POSE_STREAM_SAMPLE_SIZE;
+    }
+    m_poseStreamPub.publish(m_poseStreamMsg);
+    m_publishedCount->increment();
+}
+
+// The values of the topic are normalized ([-1, 1]) and in the axes of the device
+void RosInterface::initInput(string topic, bool isTwist, SpaceNavInputCallback callback){
+    m_rosNode = afROSNode::getNode();
+    m_inputCallback = callback;
+
+    ros::NodeHandle node(*m_rosNode);
+    node.setCallbackQueue(&m_inputCallbackQueue);
+    if (isTwist){
+        m_inputSub = node.subscribe(topic, 100, &RosInterface::twistInputCallback, this, ros::TransportHints().tcpNoDelay());
+    }
+    else{
+        m_inputSub = node.subscribe(topic, 100, &RosInterface::joyInputCallback, this, ros::TransportHints().tcpNoDelay());
+    }
+
+    // A single spinner thread keeps a single producer for the input queue
+    m_inputSpinner.reset(new ros::AsyncSpinner(1, &m_inputCallbackQueue));
+    m_inputSpinner->start();
+}
+
+void RosInterface::close(){
+    // stop() waits for the callback in progress, so none runs after the return
+    if (m_inputSpinner){
+        m_inputSpinner->stop();
+        m_inputSpinner.reset();
+    }
+    m_inputSub.shutdown();
+    m_inputCallbackQueue.clear();
+}
+
+void RosInterface::joyInputCallback(const sensor_msgs::JoyConstPtr& msg){
+    SpaceNavInputSample sample;
+    if (msg->axes.size() >= 6){
+        for (int i = 0; i < 6; i++){
+            sample.m_axes[i] = msg->axes[i] * SPACENAV_FULL_SCALE;
+        }
+        sample.m_hasMotion = true;
+    }
+    for (size_t i = 0; i < msg->buttons.size() && i < SPACENAV_MAX_BUTTONS; i++){
+        if (msg->buttons[i]){
+            sample.m_buttons |= 1u << i;
+        }
+    }
+    sample.m_hasButtons = !msg->buttons.empty();
+    m_inputCallback(sample);
+}
+
+void RosInterface::twistInputCallback(const geometry_msgs::TwistConstPtr& msg){
+    SpaceNavInputSample sample;
+    sample.m_axes[0] = msg->linear.x * SPACENAV_FULL_SCALE;
+    sample.m_axes[1] = msg->linear.y * SPACENAV_FULL_SCALE;
+    sample.m_axes[2] = msg->linear.z * SPACENAV_FULL_SCALE;
+    sample.m_axes[3] = msg->angular.x * SPACENAV_FULL_SCALE;
+    sample.m_axes[4] = msg->angular.y * SPACENAV_FULL_SCALE;
+    sample.m_axes[5] = msg->angular.z * SPACENAV_FULL_SCALE;
+    sample.m_hasMotion = true;
+    m_inputCallback(sample);
 }
\ No newline at end of file
@@ -46,17 +46,67 @@
 #include "ros/ros.h"
 #include <ambf_server/RosComBase.h>
 #include <std_msgs/Float32MultiArray.h>
+#include <std_msgs/Float64MultiArray.h>
+#include <std_msgs/Int64MultiArray.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/Joy.h>
+#include <geometry_msgs/TwistStamped.h>
+#include <geometry_msgs/Twist.h>
+#include <ros/callback_queue.h>
+#include <functional>
+#include <memory>
+#include "spacenav_input.h"
+#include "metrics.h"
+#include "pose_stream.h"
+#include "tracer.h"
 using namespace std;
 
+typedef function<void(const SpaceNavInputSample& a_sample)> SpaceNavInputCallback;
+
 class RosInterface{
     public:
         RosInterface();
+        ~RosInterface(){ close(); }
         void init(string ns);
+        void initSliceImage();
+        void initStatistics();
+        void initDeviceState(int queueSize);
+        void initInput(string topic, bool isTwist, SpaceNavInputCallback callback);
+        // Stops the input callbacks. Call before the receiver of the callback is destroyed
+        void close();
+        void initPoseStream(int maxSamples);
         void publishAxisValue(int axis, double value);
+        void publishSliceImage(const vector<uint8_t>& image, int width, int height);
+        void publishDeviceState(const double* twist, const int* buttons, int numButtons);
+        void publishStatistics(int min, int max, long long count, long long countAboveThreshold, const long long* histogram);
+        void publishPoseBatch(PoseStream* stream);
 
     private:
         ros::NodeHandle* m_rosNode;
+        string m_namespace;
+        MetricCounter* m_publishedCount = nullptr;
         ros::Publisher m_axisValuePub;
+        std_msgs::Float32MultiArray m_axisValueMsg;
+        ros::Publisher m_joyPub;
+        ros::Publisher m_twistPub;
+        sensor_msgs::Joy m_joyMsg;
+        geometry_msgs::TwistStamped m_twistMsg;
+        unsigned int m_deviceStateSeq = 0;
+
+        // External input, received on its own single threaded callback queue
+        void joyInputCallback(const sensor_msgs::JoyConstPtr& msg);
+        void twistInputCallback(const geometry_msgs::TwistConstPtr& msg);
+        ros::CallbackQueue m_inputCallbackQueue;
+        unique_ptr<ros::AsyncSpinner> m_inputSpinner;
+        ros::Subscriber m_inputSub;
+        SpaceNavInputCallback m_inputCallback;
+        ros::Publisher m_sliceImagePub;
+        sensor_msgs::Image m_sliceImageMsg;
+        ros::Publisher m_statisticsPub;
+        std_msgs::Int64MultiArray m_statisticsMsg; // Integers, so that the counts of large volumes stay exact
+        ros::Publisher m_poseStreamPub;
+        std_msgs::Float64MultiArray m_poseStreamMsg;
+        vector<PoseStreamSample> m_poseBatch;
 };
 
 
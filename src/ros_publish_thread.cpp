@@ -0,0 +1,146 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+
+#include "ros_publish_thread.h"
+
+using namespace std;
+
+RosPublishThread::RosPublishThread(){
+
+}
+
+RosPublishThread::~RosPublishThread(){
+    close();
+}
+
+void RosPublishThread::init(int a_queueSize){
+    close();
+    m_queue.init(a_queueSize);
+    m_running = true;
+    m_thread = thread(&RosPublishThread::sendLoop, this);
+}
+
+void RosPublishThread::close(){
+    if (!m_thread.joinable()){
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_condition.notify_one();
+    m_thread.join();
+
+    cerr << "INFO! ROS publishing: " << m_enqueued << " enqueued, " << m_sent << " sent, " << m_dropped << " dropped" << endl;
+}
+
+void RosPublishThread::publishAxisValue(RosInterface* a_interface, int a_axis, double a_value){
+    RosPublishRequest request;
+    request.m_interface = a_interface;
+    request.m_type = RosPublishType::AXIS_VALUE;
+    request.m_axis = a_axis;
+    request.m_value = a_value;
+    enqueue(request);
+}
+
+void RosPublishThread::publishDeviceState(RosInterface* a_interface, const double* a_twist, const int* a_buttons){
+    RosPublishRequest request;
+    request.m_interface = a_interface;
+    request.m_type = RosPublishType::DEVICE_STATE;
+    for (int i = 0; i < 6; i++){
+        request.m_twist[i] = a_twist[i];
+    }
+    request.m_buttons[0] = a_buttons[0];
+    request.m_buttons[1] = a_buttons[1];
+    enqueue(request);
+}
+
+void RosPublishThread::publishPoseBatch(RosInterface* a_interface, PoseStream* a_poseStream){
+    RosPublishRequest request;
+    request.m_interface = a_interface;
+    request.m_type = RosPublishType::POSE_BATCH;
+    request.m_poseStream = a_poseStream;
+    enqueue(request);
+}
+
+void RosPublishThread::enqueue(const RosPublishRequest& a_request){
+    if (m_queue.pushOverwrite(a_request)){
+        m_dropped++;
+    }
+    m_enqueued++;
+
+    if (m_sleeping.load(memory_order_acquire)){
+        m_condition.notify_one();
+    }
+}
+
+void RosPublishThread::sendLoop(){
+    SPACENAV_TRACE_THREAD_NAME("ros publish");
+    RosPublishRequest request;
+    while (true){
+        while (m_queue.pop(request)){
+            switch (request.m_type){
+            case RosPublishType::AXIS_VALUE:
+                request.m_interface->publishAxisValue(request.m_axis, request.m_value);
+                break;
+            case RosPublishType::DEVICE_STATE:
+                request.m_interface->publishDeviceState(request.m_twist, request.m_buttons, 2);
+                break;
+            case RosPublishType::POSE_BATCH:
+                request.m_interface->publishPoseBatch(request.m_poseStream);
+                break;
+            }
+            m_sent++;
+        }
+
+        unique_lock<mutex> lock(m_mutex);
+        if (!m_running){
+            return;
+        }
+
+        // The timeout bounds the latency if a notification is missed between the last pop and the wait
+        m_sleeping.store(true, memory_order_release);
+        m_condition.wait_for(lock, chrono::milliseconds(1), [this]{ return !m_running || m_queue.size() > 0; });
+        m_sleeping.store(false, memory_order_release);
+    }
+}
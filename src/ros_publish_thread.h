@@ -0,0 +1,109 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+#ifndef ROS_PUBLISH_THREAD_H
+#define ROS_PUBLISH_THREAD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "ros_interface.h"
+#include "spsc_queue.h"
+
+using namespace std;
+
+enum class RosPublishType{
+    AXIS_VALUE=0,
+    DEVICE_STATE=1,
+    POSE_BATCH=2
+};
+
+struct RosPublishRequest{
+    RosInterface* m_interface = nullptr;
+    PoseStream* m_poseStream = nullptr;
+    RosPublishType m_type = RosPublishType::AXIS_VALUE;
+    int m_axis = 0;
+    double m_value = 0.0;
+    double m_twist[6];
+    int m_buttons[2];
+};
+
+// Publishes the ROS messages on a dedicated sender thread so that the physics thread never
+// waits on serialization or on the publisher locks. Requests go through a bounded ring
+// where the oldest request is dropped when the sender falls behind.
+class RosPublishThread{
+    public:
+        RosPublishThread();
+        ~RosPublishThread();
+
+        void init(int a_queueSize);
+        void close();
+
+        // Called from the physics thread only
+        void publishAxisValue(RosInterface* a_interface, int a_axis, double a_value);
+        void publishDeviceState(RosInterface* a_interface, const double* a_twist, const int* a_buttons);
+        // The samples are drained from the stream on the sender thread
+        void publishPoseBatch(RosInterface* a_interface, PoseStream* a_poseStream);
+
+        unsigned long getEnqueuedCount(){ return m_enqueued.load(); }
+        unsigned long getSentCount(){ return m_sent.load(); }
+        unsigned long getDroppedCount(){ return m_dropped.load(); }
+
+    private:
+        void enqueue(const RosPublishRequest& a_request);
+        void sendLoop();
+
+        SpscQueue<RosPublishRequest> m_queue;
+        thread m_thread;
+        atomic<bool> m_running{false};
+
+        // The sender sleeps when the queue is empty and is only woken up if it is sleeping
+        mutex m_mutex;
+        condition_variable m_condition;
+        atomic<bool> m_sleeping{false};
+
+        atomic<unsigned long> m_enqueued{0};
+        atomic<unsigned long> m_sent{0};
+        atomic<unsigned long> m_dropped{0};
+};
+
+#endif //ROS_PUBLISH_THREAD_H
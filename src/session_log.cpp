@@ -0,0 +1,261 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+
+#include "session_log.h"
+#include <chrono>
+#include <iostream>
+#include <string.h>
+#include "tracer.h"
+
+using namespace std;
+
+static_assert(sizeof(SessionLogFileHeader) == SESSION_LOG_ALIGNMENT, "The file header has to fill one alignment");
+static_assert(sizeof(SessionLogChunkHeader) == SESSION_LOG_ALIGNMENT, "The chunk header has to fill one alignment");
+static_assert(sizeof(SessionLogColumnInfo) == 64 && sizeof(SessionLogChunkInfo) == 32, "Unexpected padding in the footer");
+
+static uint64_t alignUp(uint64_t a_value)
+{
+    return (a_value + SESSION_LOG_ALIGNMENT - 1) & ~uint64_t(SESSION_LOG_ALIGNMENT - 1);
+}
+
+static uint32_t getTypeSize(SessionLogType a_type)
+{
+    return a_type == SessionLogType::FLOAT64 ? 8 : 4;
+}
+
+bool SessionLog::open(const string& a_filepath, const vector<string>& a_objects, int a_chunkRows, int a_queueSize)
+{
+    close();
+    if (a_chunkRows <= 0 || a_queueSize <= 0){
+        cerr << "[ERROR] The chunk rows and the queue size of the session log have to be positive." << endl;
+        return false;
+    }
+    m_file.open(a_filepath, ios::binary | ios::trunc);
+    if (!m_file.is_open()){
+        cerr << "[ERROR] Could not open the session log " << a_filepath << endl;
+        return false;
+    }
+    m_filepath = a_filepath;
+    m_objectCount = int(a_objects.size());
+    m_chunkRows = a_chunkRows;
+
+    m_columns.clear();
+    addColumn("time", SessionLogType::FLOAT64, 1);
+    addColumn("command", SessionLogType::FLOAT32, 6);
+    addColumn("buttons", SessionLogType::UINT32, 1);
+    addColumn("active", SessionLogType::INT32, 1);
+    for (const string& object: a_objects){
+        addColumn(object + "/pos", SessionLogType::FLOAT64, 3);
+        addColumn(object + "/quat", SessionLogType::FLOAT32, 4);
+    }
+    const SessionLogColumnInfo& last = m_columns.back();
+    m_chunk.assign(alignUp(last.m_offset + uint64_t(m_chunkRows) * last.m_width * getTypeSize(SessionLogType(last.m_type))), 0);
+    m_chunks.clear();
+    m_chunkFill = 0;
+    m_rowCount = 0;
+
+    // The counts and the footer offset are filled at close
+    SessionLogFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_magic, SESSION_LOG_MAGIC, sizeof(SESSION_LOG_MAGIC));
+    header.m_version = SESSION_LOG_VERSION;
+    header.m_headerSize = sizeof(header);
+    header.m_columnCount = uint32_t(m_columns.size());
+    header.m_chunkRows = uint32_t(m_chunkRows);
+    m_file.write((const char*)&header, sizeof(header));
+    m_offset = sizeof(header);
+
+    m_rows.init(a_queueSize);
+    m_poses.init(size_t(a_queueSize) * max(m_objectCount, 1));
+    m_dropped = 0;
+    m_running = true;
+    m_writerThread = thread(&SessionLog::writerLoop, this);
+    return true;
+}
+
+void SessionLog::addColumn(const string& a_name, SessionLogType a_type, uint32_t a_width)
+{
+    SessionLogColumnInfo column;
+    memset(&column, 0, sizeof(column));
+    if (a_name.size() >= SESSION_LOG_NAME_SIZE){
+        cerr << "INFO! The name of the session log column " << a_name << " is truncated to " << SESSION_LOG_NAME_SIZE - 1 << " characters" << endl;
+    }
+    strncpy(column.m_name, a_name.c_str(), SESSION_LOG_NAME_SIZE - 1);
+    column.m_type = uint32_t(a_type);
+    column.m_width = a_width;
+    if (m_columns.empty()){
+        column.m_offset = sizeof(SessionLogChunkHeader);
+    }
+    else{
+        const SessionLogColumnInfo& previous = m_columns.back();
+        column.m_offset = uint32_t(alignUp(previous.m_offset + uint64_t(m_chunkRows) * previous.m_width * getTypeSize(SessionLogType(previous.m_type))));
+    }
+    m_columns.push_back(column);
+}
+
+// The poses are pushed before the row, so the writer finds them once it has the row
+bool SessionLog::record(const SessionLogRow& a_row, const SessionLogPose* a_poses)
+{
+    if (m_rows.size() >= m_rows.capacity() || m_poses.capacity() - m_poses.size() < size_t(m_objectCount)){
+        m_dropped++;
+        return false;
+    }
+    for (int i = 0; i < m_objectCount; i++){
+        m_poses.push(a_poses[i]);
+    }
+    m_rows.push(a_row);
+    return true;
+}
+
+void SessionLog::writerLoop()
+{
+    SPACENAV_TRACE_THREAD_NAME("session log");
+    while (m_running.load(memory_order_relaxed)){
+        if (drain() == 0){
+            this_thread::sleep_for(chrono::milliseconds(5));
+        }
+    }
+    drain();
+    if (m_chunkFill > 0){
+        writeChunk();
+    }
+    writeFooter();
+}
+
+// Transposes the queued rows into the column blocks of the current chunk
+int SessionLog::drain()
+{
+    int count = 0;
+    SessionLogRow row;
+    SessionLogPose pose;
+    while (m_rows.pop(row)){
+        if (m_chunkFill == 0){
+            m_chunkFirstTime = row.m_time;
+        }
+        m_chunkLastTime = row.m_time;
+        unsigned char* chunk = m_chunk.data();
+        uint32_t r = m_chunkFill;
+        memcpy(chunk + m_columns[0].m_offset + r * sizeof(double), &row.m_time, sizeof(double));
+        memcpy(chunk + m_columns[1].m_offset + r * sizeof(row.m_command), row.m_command, sizeof(row.m_command));
+        memcpy(chunk + m_columns[2].m_offset + r * sizeof(uint32_t), &row.m_buttons, sizeof(uint32_t));
+        memcpy(chunk + m_columns[3].m_offset + r * sizeof(int32_t), &row.m_active, sizeof(int32_t));
+        for (int i = 0; i < m_objectCount; i++){
+            m_poses.pop(pose);
+            memcpy(chunk + m_columns[4 + 2 * i].m_offset + r * sizeof(pose.m_pos), pose.m_pos, sizeof(pose.m_pos));
+            memcpy(chunk + m_columns[5 + 2 * i].m_offset + r * sizeof(pose.m_quat), pose.m_quat, sizeof(pose.m_quat));
+        }
+        m_rowCount++;
+        count++;
+        if (++m_chunkFill == uint32_t(m_chunkRows)){
+            writeChunk();
+        }
+    }
+    return count;
+}
+
+// Every chunk has the size of a full one, so the column offsets are the same in all of them
+void SessionLog::writeChunk()
+{
+    SPACENAV_TRACE_SCOPE("SessionLog::writeChunk");
+    SessionLogChunkHeader header;
+    memset(&header, 0, sizeof(header));
+    header.m_magic = SESSION_LOG_CHUNK_MAGIC;
+    header.m_rows = m_chunkFill;
+    header.m_size = m_chunk.size();
+    header.m_firstTime = m_chunkFirstTime;
+    header.m_lastTime = m_chunkLastTime;
+    memcpy(m_chunk.data(), &header, sizeof(header));
+    // Reported once, at the first failure
+    bool good = m_file.good();
+    m_file.write((const char*)m_chunk.data(), m_chunk.size());
+    if (good && !m_file){
+        cerr << "ERROR! Could not write the session log " << m_filepath << endl;
+    }
+
+    SessionLogChunkInfo info;
+    memset(&info, 0, sizeof(info));
+    info.m_offset = m_offset;
+    info.m_rows = m_chunkFill;
+    info.m_firstTime = m_chunkFirstTime;
+    info.m_lastTime = m_chunkLastTime;
+    m_chunks.push_back(info);
+    m_offset += m_chunk.size();
+
+    // The rows past the fill of the last chunk are left zero
+    memset(m_chunk.data(), 0, m_chunk.size());
+    m_chunkFill = 0;
+}
+
+void SessionLog::writeFooter()
+{
+    uint64_t footerOffset = m_offset;
+    m_file.write((const char*)m_columns.data(), m_columns.size() * sizeof(SessionLogColumnInfo));
+    m_file.write((const char*)m_chunks.data(), m_chunks.size() * sizeof(SessionLogChunkInfo));
+
+    SessionLogFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_magic, SESSION_LOG_MAGIC, sizeof(SESSION_LOG_MAGIC));
+    header.m_version = SESSION_LOG_VERSION;
+    header.m_headerSize = sizeof(header);
+    header.m_columnCount = uint32_t(m_columns.size());
+    header.m_chunkRows = uint32_t(m_chunkRows);
+    header.m_footerOffset = footerOffset;
+    header.m_chunkCount = m_chunks.size();
+    header.m_rowCount = m_rowCount;
+    m_file.seekp(0);
+    m_file.write((const char*)&header, sizeof(header));
+    if (!m_file){
+        cerr << "ERROR! Could not write the session log " << m_filepath << endl;
+    }
+}
+
+void SessionLog::close()
+{
+    if (!m_writerThread.joinable()){
+        return;
+    }
+    m_running = false;
+    m_writerThread.join();
+    m_file.close();
+    cerr << "INFO! Session log: " << m_rowCount << " rows in " << m_chunks.size() << " chunks written to " << m_filepath
+         << ", " << m_dropped.load() << " dropped" << endl;
+}
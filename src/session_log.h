@@ -0,0 +1,176 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+#ifndef SESSION_LOG_H
+#define SESSION_LOG_H
+
+#include <atomic>
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "spsc_queue.h"
+
+using namespace std;
+
+// Layout of the file, in the native byte order (little endian). Every chunk and every
+// column block starts on a multiple of SESSION_LOG_ALIGNMENT, so the file can be mapped
+// and each column read in place as an array.
+//
+//   SessionLogFileHeader
+//   chunk 0: SessionLogChunkHeader, then one block per column of rows x width values
+//   chunk 1 ...
+//   footer: SessionLogColumnInfo x column count, SessionLogChunkInfo x chunk count
+//
+// The footer offset is written in the header at close. A file with a zero footer offset
+// was not closed, and its chunks can still be walked with their headers.
+#define SESSION_LOG_MAGIC "SNAVLOG"
+#define SESSION_LOG_VERSION 1
+#define SESSION_LOG_ALIGNMENT 64
+#define SESSION_LOG_CHUNK_MAGIC 0x4b4e4843 // "CHNK"
+#define SESSION_LOG_NAME_SIZE 48
+
+enum class SessionLogType: uint32_t{
+    FLOAT32=1,
+    FLOAT64=2,
+    INT32=3,
+    UINT32=4
+};
+
+struct SessionLogFileHeader{
+    char m_magic[8];
+    uint32_t m_version;
+    uint32_t m_headerSize;
+    uint32_t m_columnCount;
+    uint32_t m_chunkRows; // Capacity of a chunk. The last chunk may have less rows
+    uint64_t m_footerOffset;
+    uint64_t m_chunkCount;
+    uint64_t m_rowCount;
+    uint8_t m_reserved[16];
+};
+
+struct SessionLogChunkHeader{
+    uint32_t m_magic;
+    uint32_t m_rows;
+    uint64_t m_size; // Including this header. The same for every chunk
+    double m_firstTime;
+    double m_lastTime;
+    uint8_t m_reserved[32];
+};
+
+struct SessionLogColumnInfo{
+    char m_name[SESSION_LOG_NAME_SIZE];
+    uint32_t m_type; // SessionLogType
+    uint32_t m_width; // Values per row
+    uint32_t m_offset; // Of the block from the start of the chunk, the same in every chunk
+    uint32_t m_reserved;
+};
+
+struct SessionLogChunkInfo{
+    uint64_t m_offset;
+    uint32_t m_rows;
+    uint32_t m_reserved;
+    double m_firstTime;
+    double m_lastTime;
+};
+
+// World pose of one object
+struct SessionLogPose{
+    double m_pos[3] = {0.0, 0.0, 0.0};
+    float m_quat[4] = {0.0f, 0.0f, 0.0f, 1.0f}; // [x, y, z, w]
+};
+
+// Device command and active object of one tick. The poses of the objects follow in their own queue
+struct SessionLogRow{
+    double m_time = 0.0;
+    float m_command[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}; // Device twist [x, y, z, rx, ry, rz]
+    uint32_t m_buttons = 0;
+    int32_t m_active = -1; // Index of the active object
+};
+
+// Records one row per physics tick into a columnar file. The physics thread only pushes
+// into lock-free queues, the rows are transposed into chunks and written on a thread.
+class SessionLog{
+    public:
+        ~SessionLog(){ close(); }
+
+        // a_objects: names of the objects, in the order of the poses of every row
+        // a_chunkRows: rows per chunk. a_queueSize: rows buffered for the writer
+        bool open(const string& a_filepath, const vector<string>& a_objects, int a_chunkRows, int a_queueSize);
+        bool isEnabled() const{ return m_writerThread.joinable(); }
+
+        // Producer side (physics thread). a_poses has one pose per object.
+        // Returns false if the row was dropped because the writer is behind
+        bool record(const SessionLogRow& a_row, const SessionLogPose* a_poses);
+
+        // Writes the remaining rows and the footer
+        void close();
+
+    private:
+        void addColumn(const string& a_name, SessionLogType a_type, uint32_t a_width);
+        void writerLoop();
+        int drain();
+        void writeChunk();
+        void writeFooter();
+
+        string m_filepath;
+        ofstream m_file;
+        int m_objectCount = 0;
+        int m_chunkRows = 1024;
+        SpscQueue<SessionLogRow> m_rows;
+        SpscQueue<SessionLogPose> m_poses;
+        atomic<unsigned long> m_dropped{0};
+        thread m_writerThread;
+        atomic<bool> m_running{false};
+
+        // Writer side
+        vector<SessionLogColumnInfo> m_columns;
+        vector<SessionLogChunkInfo> m_chunks;
+        vector<unsigned char> m_chunk; // Column blocks of the chunk being filled
+        uint32_t m_chunkFill = 0;
+        double m_chunkFirstTime = 0.0;
+        double m_chunkLastTime = 0.0;
+        uint64_t m_offset = 0;
+        uint64_t m_rowCount = 0;
+};
+
+#endif //SESSION_LOG_H
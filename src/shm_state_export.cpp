@@ -0,0 +1,117 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+
+#include "shm_state_export.h"
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std;
+
+ShmStateExport::ShmStateExport(){
+
+}
+
+ShmStateExport::~ShmStateExport(){
+    close();
+}
+
+bool ShmStateExport::init(string a_name, uint32_t a_slotCount){
+    close();
+    if (a_slotCount == 0){
+        cerr << "ERROR! The shared memory export needs at least one slot." << endl;
+        return false;
+    }
+    if (a_name.empty() || a_name[0] != '/'){
+        a_name = "/" + a_name;
+    }
+
+    int fd = shm_open(a_name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd == -1){
+        cerr << "ERROR! FAILED TO OPEN SHARED MEMORY " << a_name << endl;
+        return false;
+    }
+
+    size_t size = SeqlockRing<SpaceNavStateSample>::getRequiredSize(a_slotCount);
+    if (ftruncate(fd, size) == -1){
+        cerr << "ERROR! FAILED TO RESIZE SHARED MEMORY " << a_name << endl;
+        ::close(fd);
+        shm_unlink(a_name.c_str());
+        return false;
+    }
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED){
+        cerr << "ERROR! FAILED TO MAP SHARED MEMORY " << a_name << endl;
+        shm_unlink(a_name.c_str());
+        return false;
+    }
+    if (!m_ring.create(memory, a_slotCount)){
+        cerr << "ERROR! FAILED TO FORMAT SHARED MEMORY " << a_name << endl;
+        munmap(memory, size);
+        shm_unlink(a_name.c_str());
+        return false;
+    }
+
+    m_name = a_name;
+    m_memory = memory;
+    m_size = size;
+
+    cerr << "INFO! Exporting the state to shared memory " << m_name << " (" << a_slotCount << " slots)" << endl;
+    return true;
+}
+
+void ShmStateExport::publish(const SpaceNavStateSample& a_sample){
+    if (m_memory){
+        m_ring.write(a_sample);
+    }
+}
+
+void ShmStateExport::close(){
+    if (m_memory){
+        munmap(m_memory, m_size);
+        shm_unlink(m_name.c_str());
+        m_memory = nullptr;
+    }
+}
@@ -0,0 +1,236 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+
+#include "slice_resampler.h"
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+SliceResampler::SliceResampler(){
+
+}
+
+SliceResampler::~SliceResampler(){
+    close();
+}
+
+bool SliceResampler::init(VoxelGrid* a_grid, WorkerPool* a_pool, int a_width, int a_height, SliceImageCallback a_callback){
+    if (!a_grid || !a_pool || a_width <= 0 || a_height <= 0){
+        cerr << "ERROR! INVALID SLICE RESAMPLER PARAMETERS" << endl;
+        return false;
+    }
+
+    close();
+    m_grid = a_grid;
+    m_pool = a_pool;
+    m_width = a_width;
+    m_height = a_height;
+    m_callback = a_callback;
+    m_image.assign(size_t(m_width) * m_height, 0);
+
+    m_running = true;
+    m_thread = thread(&SliceResampler::resampleLoop, this);
+    return true;
+}
+
+void SliceResampler::close(){
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_condition.notify_all();
+    if (m_thread.joinable()){
+        m_thread.join();
+    }
+}
+
+void SliceResampler::requestSlice(const SlicePlane& a_plane){
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_requestedPlane = a_plane;
+        m_hasRequest = true;
+    }
+    m_condition.notify_one();
+}
+
+void SliceResampler::resampleLoop(){
+    while (true){
+        SlicePlane plane;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]{ return !m_running || m_hasRequest; });
+            if (!m_running){
+                return;
+            }
+            plane = m_requestedPlane;
+            m_hasRequest = false;
+        }
+
+        if (!m_grid->isReady()){
+            continue;
+        }
+
+        resample(plane, m_image);
+        if (m_callback){
+            m_callback(m_image, m_width, m_height);
+        }
+    }
+}
+
+void SliceResampler::resample(const SlicePlane& a_plane, vector<uint8_t>& a_image){
+    a_image.resize(size_t(m_width) * m_height);
+    uint8_t* image = a_image.data();
+    m_pool->parallelFor(m_height, [&](int a_begin, int a_end, int){
+        for (int row = a_begin; row < a_end; row++){
+            resampleRow(a_plane, row, image + size_t(row) * m_width);
+        }
+    });
+}
+
+// Trilinear interpolation at grid coordinates (voxel centers are at integer coordinates)
+uint8_t SliceResampler::sample(float a_x, float a_y, float a_z){
+    const int* size = m_grid->m_size;
+    if (a_x < -0.5f || a_y < -0.5f || a_z < -0.5f || a_x > size[0] - 0.5f || a_y > size[1] - 0.5f || a_z > size[2] - 0.5f){
+        return 0;
+    }
+
+    a_x = cClamp(a_x, 0.0f, float(size[0] - 1));
+    a_y = cClamp(a_y, 0.0f, float(size[1] - 1));
+    a_z = cClamp(a_z, 0.0f, float(size[2] - 1));
+    int x0 = int(a_x), y0 = int(a_y), z0 = int(a_z);
+    int x1 = min(x0 + 1, size[0] - 1), y1 = min(y0 + 1, size[1] - 1), z1 = min(z0 + 1, size[2] - 1);
+    float fx = a_x - x0, fy = a_y - y0, fz = a_z - z0;
+
+    float c00 = m_grid->get(x0, y0, z0) + fx * (m_grid->get(x1, y0, z0) - m_grid->get(x0, y0, z0));
+    float c10 = m_grid->get(x0, y1, z0) + fx * (m_grid->get(x1, y1, z0) - m_grid->get(x0, y1, z0));
+    float c01 = m_grid->get(x0, y0, z1) + fx * (m_grid->get(x1, y0, z1) - m_grid->get(x0, y0, z1));
+    float c11 = m_grid->get(x0, y1, z1) + fx * (m_grid->get(x1, y1, z1) - m_grid->get(x0, y1, z1));
+    float c0 = c00 + fy * (c10 - c00);
+    float c1 = c01 + fy * (c11 - c01);
+    return uint8_t(c0 + fz * (c1 - c0) + 0.5f);
+}
+
+void SliceResampler::resampleRow(const SlicePlane& a_plane, int a_row, uint8_t* a_out){
+    const int* size = m_grid->m_size;
+
+    // Grid coordinate of pixel i of the row: g = start + step * i
+    cVector3d rowOrigin = a_plane.m_origin + a_plane.m_v * ((a_row + 0.5) / m_height) + a_plane.m_u * (0.5 / m_width);
+    cVector3d rowStep = a_plane.m_u / double(m_width);
+    float start[3], step[3];
+    for (int k = 0; k < 3; k++){
+        start[k] = float(rowOrigin(k) * size[k] - 0.5);
+        step[k] = float(rowStep(k) * size[k]);
+    }
+
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 half = _mm_set1_ps(0.5f);
+    __m128 vStart[3], vStep[3], vLow, vHigh[3], vMax[3];
+    vLow = _mm_set1_ps(-0.5f);
+    for (int k = 0; k < 3; k++){
+        vStart[k] = _mm_set1_ps(start[k]);
+        vStep[k] = _mm_set1_ps(step[k]);
+        vHigh[k] = _mm_set1_ps(size[k] - 0.5f);
+        vMax[k] = _mm_set1_ps(float(size[k] - 1));
+    }
+
+    alignas(16) int idx[3][4];
+    alignas(16) float corner[8][4];
+    for (; i + 4 <= m_width; i += 4){
+        __m128 pixel = _mm_add_ps(_mm_set1_ps(float(i)), lane);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        __m128 frac[3];
+        for (int k = 0; k < 3; k++){
+            __m128 g = _mm_add_ps(vStart[k], _mm_mul_ps(vStep[k], pixel));
+            inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(g, vLow), _mm_cmple_ps(g, vHigh[k])));
+            g = _mm_min_ps(_mm_max_ps(g, zero), vMax[k]);
+            __m128i gi = _mm_cvttps_epi32(g);
+            frac[k] = _mm_sub_ps(g, _mm_cvtepi32_ps(gi));
+            _mm_store_si128((__m128i*)idx[k], gi);
+        }
+
+        // Gather the 8 neighbours of each of the 4 samples
+        for (int l = 0; l < 4; l++){
+            int x0 = idx[0][l], y0 = idx[1][l], z0 = idx[2][l];
+            int x1 = min(x0 + 1, size[0] - 1), y1 = min(y0 + 1, size[1] - 1), z1 = min(z0 + 1, size[2] - 1);
+            corner[0][l] = m_grid->get(x0, y0, z0);
+            corner[1][l] = m_grid->get(x1, y0, z0);
+            corner[2][l] = m_grid->get(x0, y1, z0);
+            corner[3][l] = m_grid->get(x1, y1, z0);
+            corner[4][l] = m_grid->get(x0, y0, z1);
+            corner[5][l] = m_grid->get(x1, y0, z1);
+            corner[6][l] = m_grid->get(x0, y1, z1);
+            corner[7][l] = m_grid->get(x1, y1, z1);
+        }
+
+        __m128 c[8];
+        for (int k = 0; k < 8; k++){
+            c[k] = _mm_load_ps(corner[k]);
+        }
+        __m128 c00 = _mm_add_ps(c[0], _mm_mul_ps(frac[0], _mm_sub_ps(c[1], c[0])));
+        __m128 c10 = _mm_add_ps(c[2], _mm_mul_ps(frac[0], _mm_sub_ps(c[3], c[2])));
+        __m128 c01 = _mm_add_ps(c[4], _mm_mul_ps(frac[0], _mm_sub_ps(c[5], c[4])));
+        __m128 c11 = _mm_add_ps(c[6], _mm_mul_ps(frac[0], _mm_sub_ps(c[7], c[6])));
+        __m128 c0 = _mm_add_ps(c00, _mm_mul_ps(frac[1], _mm_sub_ps(c10, c00)));
+        __m128 c1 = _mm_add_ps(c01, _mm_mul_ps(frac[1], _mm_sub_ps(c11, c01)));
+        __m128 value = _mm_add_ps(c0, _mm_mul_ps(frac[2], _mm_sub_ps(c1, c0)));
+        value = _mm_and_ps(_mm_add_ps(value, half), inside);
+
+        // Pack the 4 results into bytes
+        __m128i result = _mm_cvttps_epi32(value);
+        result = _mm_packs_epi32(result, result);
+        result = _mm_packus_epi16(result, result);
+        int packed = _mm_cvtsi128_si32(result);
+        memcpy(a_out + i, &packed, 4);
+    }
+#endif
+
+    for (; i < m_width; i++){
+        a_out[i] = sample(start[0] + step[0] * i, start[1] + step[1] * i, start[2] + step[2] * i);
+    }
+}
@@ -0,0 +1,102 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+#ifndef SLICE_RESAMPLER_H
+#define SLICE_RESAMPLER_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "voxel_grid.h"
+#include "worker_pool.h"
+
+using namespace chai3d;
+using namespace std;
+
+// Plane to sample, in normalized texture coordinates of the volume ([0, 1] along each axis)
+struct SlicePlane{
+    cVector3d m_origin; // Corner of the image
+    cVector3d m_u; // Span of the image along its width
+    cVector3d m_v; // Span of the image along its height
+};
+
+typedef function<void(const vector<uint8_t>& a_image, int a_width, int a_height)> SliceImageCallback;
+
+// Extracts 2D slices of a VoxelGrid with trilinear interpolation. The rows of the
+// image are split across the worker pool and each row is sampled 4 pixels at a time with SSE.
+class SliceResampler{
+    public:
+        SliceResampler();
+        ~SliceResampler();
+
+        bool init(VoxelGrid* a_grid, WorkerPool* a_pool, int a_width, int a_height, SliceImageCallback a_callback);
+        void close();
+
+        // Samples the plane on the calling thread (with the help of the worker pool)
+        void resample(const SlicePlane& a_plane, vector<uint8_t>& a_image);
+
+        // Samples the plane on the resampler thread and hands the image to the callback.
+        // Requests that arrive while a slice is being sampled are coalesced into the latest one.
+        void requestSlice(const SlicePlane& a_plane);
+
+        int m_width = 256;
+        int m_height = 256;
+
+    private:
+        void resampleRow(const SlicePlane& a_plane, int a_row, uint8_t* a_out);
+        uint8_t sample(float a_x, float a_y, float a_z);
+        void resampleLoop();
+
+        VoxelGrid* m_grid = nullptr;
+        WorkerPool* m_pool = nullptr;
+        SliceImageCallback m_callback;
+        vector<uint8_t> m_image;
+
+        thread m_thread;
+        mutex m_mutex;
+        condition_variable m_condition;
+        SlicePlane m_requestedPlane;
+        bool m_hasRequest = false;
+        bool m_running = false;
+};
+
+#endif //SLICE_RESAMPLER_H
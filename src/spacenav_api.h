@@ -0,0 +1,121 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef SPACENAV_API_H
+#define SPACENAV_API_H
+
+// In-process interface of the spacenav plugin for the other plugins loaded in the same
+// simulator. Like spacenav_state.h, it has no dependency other than the standard library
+// and libdl, and the consumers do not link against the plugin.
+//
+//     SpaceNavApiReader reader;
+//     if (reader.connect("spacenav")){
+//         SpaceNavStateSample sample;
+//         if (reader.readLatest(sample)){ ... }
+//     }
+
+#include <dlfcn.h>
+#include "spacenav_state.h"
+
+#define SPACENAV_API_VERSION 1
+#define SPACENAV_API_LOOKUP_SYMBOL "spacenav_api_lookup"
+#define SPACENAV_API_LIBRARY "libspacenav_plugin.so"
+
+// Published by the plugin under a name. Only the fields of the same version can be used
+struct SpaceNavApiHandle{
+    uint32_t m_version = SPACENAV_API_VERSION;
+    uint32_t m_sampleSize = sizeof(SpaceNavStateSample);
+    void* m_stateRing = nullptr; // SeqlockRing<SpaceNavStateSample>, written after every physics step
+};
+
+extern "C" {
+typedef const SpaceNavApiHandle* (*SpaceNavApiLookupFunction)(const char* a_name);
+}
+
+// Read-only view of the state published by the plugin. The reads copy the latest sample
+// without locking, and the plugin never waits on the readers. The reader has to stop being
+// used when the plugin is closed.
+class SpaceNavApiReader{
+    public:
+        // a_library: used if the plugin was loaded without its symbols in the global scope
+        bool connect(const char* a_name = "spacenav", const char* a_library = SPACENAV_API_LIBRARY){
+            m_ring = SeqlockRing<SpaceNavStateSample>();
+            SpaceNavApiLookupFunction lookup = (SpaceNavApiLookupFunction)dlsym(RTLD_DEFAULT, SPACENAV_API_LOOKUP_SYMBOL);
+            if (!lookup && a_library){
+                void* library = dlopen(a_library, RTLD_NOW | RTLD_NOLOAD);
+                if (library){
+                    lookup = (SpaceNavApiLookupFunction)dlsym(library, SPACENAV_API_LOOKUP_SYMBOL);
+                    // The plugin stays loaded by the simulator
+                    dlclose(library);
+                }
+            }
+            if (!lookup){
+                return false;
+            }
+
+            const SpaceNavApiHandle* handle = lookup(a_name);
+            if (!handle || handle->m_version != SPACENAV_API_VERSION || handle->m_sampleSize != sizeof(SpaceNavStateSample)){
+                return false;
+            }
+            return m_ring.attach(handle->m_stateRing);
+        }
+
+        bool isConnected() const{ return m_ring.isValid(); }
+
+        bool readLatest(SpaceNavStateSample& a_sample, uint64_t* a_index = nullptr) const{
+            return m_ring.isValid() && m_ring.readLatest(a_sample, a_index);
+        }
+
+        // Sample number a_index, for a consumer that does not want to miss any step
+        bool read(uint64_t a_index, SpaceNavStateSample& a_sample) const{
+            return m_ring.isValid() && m_ring.read(a_index, a_sample);
+        }
+
+        uint64_t getWriteIndex() const{
+            return m_ring.isValid() ? m_ring.getWriteIndex() : 0;
+        }
+
+    private:
+        SeqlockRing<SpaceNavStateSample> m_ring;
+};
+
+#endif //SPACENAV_API_H
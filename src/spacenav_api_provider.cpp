@@ -0,0 +1,118 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "spacenav_api_provider.h"
+#include <iostream>
+
+using namespace std;
+
+SpaceNavApiRegistry* SpaceNavApiRegistry::getInstance(){
+    static SpaceNavApiRegistry s_instance;
+    return &s_instance;
+}
+
+bool SpaceNavApiRegistry::add(const string& a_name, const SpaceNavApiHandle* a_handle){
+    lock_guard<mutex> lock(m_mutex);
+    if (m_handles.count(a_name)){
+        cerr << "ERROR! An interface named " << a_name << " is already registered" << endl;
+        return false;
+    }
+    m_handles[a_name] = a_handle;
+    return true;
+}
+
+void SpaceNavApiRegistry::remove(const string& a_name){
+    lock_guard<mutex> lock(m_mutex);
+    m_handles.erase(a_name);
+}
+
+const SpaceNavApiHandle* SpaceNavApiRegistry::find(const string& a_name){
+    lock_guard<mutex> lock(m_mutex);
+    auto it = m_handles.find(a_name);
+    return it != m_handles.end() ? it->second : nullptr;
+}
+
+SpaceNavApiProvider::SpaceNavApiProvider(){
+
+}
+
+SpaceNavApiProvider::~SpaceNavApiProvider(){
+    close();
+}
+
+bool SpaceNavApiProvider::init(const string& a_name, uint32_t a_slotCount){
+    close();
+    if (a_name.empty() || a_slotCount == 0){
+        cerr << "[ERROR] The in-process interface needs a name and at least one slot." << endl;
+        return false;
+    }
+
+    size_t size = SeqlockRing<SpaceNavStateSample>::getRequiredSize(a_slotCount);
+    m_memory.assign((size + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+    m_ring.create(m_memory.data(), a_slotCount);
+    m_handle.m_stateRing = m_memory.data();
+    if (!SpaceNavApiRegistry::getInstance()->add(a_name, &m_handle)){
+        return false;
+    }
+    m_name = a_name;
+    cerr << "INFO! In-process interface registered as " << m_name << endl;
+    return true;
+}
+
+void SpaceNavApiProvider::publish(const SpaceNavStateSample& a_sample){
+    if (isEnabled()){
+        m_ring.write(a_sample);
+    }
+}
+
+void SpaceNavApiProvider::close(){
+    if (!isEnabled()){
+        return;
+    }
+    SpaceNavApiRegistry::getInstance()->remove(m_name);
+    m_name.clear();
+}
+
+extern "C" const SpaceNavApiHandle* spacenav_api_lookup(const char* a_name){
+    return a_name ? SpaceNavApiRegistry::getInstance()->find(a_name) : nullptr;
+}
@@ -0,0 +1,91 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef SPACENAV_API_PROVIDER_H
+#define SPACENAV_API_PROVIDER_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "spacenav_api.h"
+
+using namespace std;
+
+// Handles published in the process, by name. Only locked at the registration and the lookup
+class SpaceNavApiRegistry{
+    public:
+        static SpaceNavApiRegistry* getInstance();
+
+        bool add(const string& a_name, const SpaceNavApiHandle* a_handle);
+        void remove(const string& a_name);
+        const SpaceNavApiHandle* find(const string& a_name);
+
+    private:
+        SpaceNavApiRegistry(){}
+
+        mutex m_mutex;
+        map<string, const SpaceNavApiHandle*> m_handles;
+};
+
+// Plugin side of the interface. The state is written to a seqlock ring in the process memory
+class SpaceNavApiProvider{
+    public:
+        SpaceNavApiProvider();
+        ~SpaceNavApiProvider();
+
+        bool init(const string& a_name, uint32_t a_slotCount);
+        void publish(const SpaceNavStateSample& a_sample);
+        void close();
+        bool isEnabled(){ return !m_name.empty(); }
+
+    private:
+        string m_name;
+        vector<uint64_t> m_memory;
+        SeqlockRing<SpaceNavStateSample> m_ring;
+        SpaceNavApiHandle m_handle;
+};
+
+// Looked up with dlsym by SpaceNavApiReader
+extern "C" const SpaceNavApiHandle* spacenav_api_lookup(const char* a_name);
+
+#endif //SPACENAV_API_PROVIDER_H
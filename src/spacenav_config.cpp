@@ -0,0 +1,388 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "spacenav_config.h"
+#include "spacenav_input.h"
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+SpaceNavControlParams::SpaceNavControlParams(){
+    double full_scale = 0.001 / 512.0;
+    for (int i = 0; i < 3; i++){
+        m_scale[i] = 0.5 * full_scale;
+        m_scale[3 + i] = 50.0 * full_scale;
+        m_deadband[i] = 0.1;
+        m_deadband[3 + i] = 0.1;
+    }
+}
+
+SpaceNavConfig::SpaceNavConfig(){
+
+}
+
+bool SpaceNavConfig::load(const YAML::Node& a_node){
+    bool result = true;
+    m_objects.clear();
+    m_profiles.clear();
+
+    for (size_t i = 0; i < a_node["control objects"].size(); i++){
+        SpaceNavObjectConfig object;
+        if (parseObject(a_node["control objects"][i], object)){
+            m_objects.push_back(object);
+        }
+        else{
+            result = false;
+        }
+    }
+
+    // The top level parameters are the default profile
+    m_defaultParams = SpaceNavControlParams();
+    result &= parseParams(a_node, "default", m_defaultParams);
+    if (a_node["profiles"] && a_node["profiles"]["default"]){
+        result &= parseParams(a_node["profiles"]["default"], "default", m_defaultParams);
+    }
+
+    if (a_node["idle time"]){
+        m_idleTime = a_node["idle time"].as<double>();
+    }
+    // The count of polls depended on the physics rate, it is converted at the nominal 1 kHz
+    else if (a_node["static count threshold"]){
+        m_idleTime = a_node["static count threshold"].as<int>() * 0.001;
+        cerr << "INFO! \"static count threshold\" is replaced by \"idle time\". Using an idle time of " << m_idleTime << " s" << endl;
+    }
+    if (m_idleTime < 0.0){
+        cerr << "[ERROR] The idle time can not be negative." << endl;
+        result = false;
+    }
+
+    if (a_node["adaptive deadband"]){
+        YAML::Node deadbandNode = a_node["adaptive deadband"];
+        m_adaptiveDeadband.m_enabled = deadbandNode["enabled"] ? deadbandNode["enabled"].as<bool>() : true;
+        if (deadbandNode["on sigma"]){
+            m_adaptiveDeadband.m_onSigma = deadbandNode["on sigma"].as<double>();
+        }
+        if (deadbandNode["off sigma"]){
+            m_adaptiveDeadband.m_offSigma = deadbandNode["off sigma"].as<double>();
+        }
+        if (deadbandNode["min threshold"]){
+            m_adaptiveDeadband.m_minThreshold = deadbandNode["min threshold"].as<double>();
+        }
+        if (deadbandNode["max threshold"]){
+            m_adaptiveDeadband.m_maxThreshold = deadbandNode["max threshold"].as<double>();
+        }
+        if (deadbandNode["learning rate"]){
+            m_adaptiveDeadband.m_learningRate = deadbandNode["learning rate"].as<double>();
+        }
+        const AdaptiveDeadbandParams& params = m_adaptiveDeadband;
+        if (params.m_offSigma <= 0.0 || params.m_onSigma < params.m_offSigma){
+            cerr << "[ERROR] The adaptive deadband needs 0 < off sigma <= on sigma." << endl;
+            result = false;
+        }
+        if (params.m_minThreshold <= 0.0 || params.m_maxThreshold < params.m_minThreshold || params.m_maxThreshold >= SPACENAV_FULL_SCALE){
+            cerr << "[ERROR] The adaptive deadband needs 0 < min threshold <= max threshold < " << SPACENAV_FULL_SCALE << "." << endl;
+            result = false;
+        }
+        if (params.m_learningRate <= 0.0 || params.m_learningRate > 1.0){
+            cerr << "[ERROR] The learning rate of the adaptive deadband has to be in (0, 1]." << endl;
+            result = false;
+        }
+    }
+
+    m_buttonBindings.clear();
+    if (a_node["buttons"]){
+        if (a_node["buttons"]["long press time"]){
+            m_longPressTime = a_node["buttons"]["long press time"].as<double>();
+        }
+        result &= parseButtons(a_node["buttons"]["actions"], m_buttonBindings);
+    }
+
+    // The other profiles only override what they define
+    if (a_node["profiles"]){
+        if (!a_node["profiles"].IsMap()){
+            cerr << "[ERROR] profiles has to be a map of profile names to parameters." << endl;
+            return false;
+        }
+        for (YAML::const_iterator it = a_node["profiles"].begin(); it != a_node["profiles"].end(); ++it){
+            string name = it->first.as<string>();
+            if (name == "default"){
+                continue;
+            }
+            SpaceNavControlParams params = m_defaultParams;
+            result &= parseParams(it->second, name, params);
+            m_profiles[name] = params;
+        }
+    }
+
+    for (const SpaceNavObjectConfig& object: m_objects){
+        if (!object.m_profile.empty() && m_profiles.find(object.m_profile) == m_profiles.end()){
+            cerr << "[ERROR] Object \"" << object.m_name << "\" uses the undefined profile \"" << object.m_profile << "\"" << endl;
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+const SpaceNavControlParams& SpaceNavConfig::getParams(const string& a_objectName, const string& a_profile) const{
+    auto it = m_profiles.find(a_profile.empty() ? a_objectName : a_profile);
+    if (it != m_profiles.end()){
+        return it->second;
+    }
+    return m_defaultParams;
+}
+
+// Either "TYPE name" or {type: TYPE, name: name, profile: profile}
+bool SpaceNavConfig::parseObject(const YAML::Node& a_node, SpaceNavObjectConfig& a_object){
+    if (a_node.IsMap()){
+        if (!a_node["name"]){
+            cerr << "[ERROR] Control object without a name." << endl;
+            return false;
+        }
+        a_object.m_name = a_node["name"].as<string>();
+        a_object.m_type = a_node["type"] ? a_node["type"].as<string>() : "";
+        a_object.m_profile = a_node["profile"] ? a_node["profile"].as<string>() : "";
+    }
+    else{
+        string spec = a_node.as<string>();
+        stringstream stream(spec);
+        string extra;
+        stream >> a_object.m_type >> a_object.m_name >> extra;
+        if (a_object.m_name.empty() || !extra.empty()){
+            cerr << "[ERROR] Control object \"" << spec << "\" has to be \"TYPE name\"." << endl;
+            return false;
+        }
+    }
+
+    const vector<string> types = {"", "CAMERA", "LIGHT", "VOLUME", "BODY", "JOINT", "OBJECT"};
+    for (const string& type: types){
+        if (a_object.m_type == type){
+            return true;
+        }
+    }
+    cerr << "[ERROR] Unknown type \"" << a_object.m_type << "\" for the control object \"" << a_object.m_name << "\"." << endl;
+    return false;
+}
+
+// Each action is {trigger: press | release | long press | chord, buttons: [indices], action: name}
+bool SpaceNavConfig::parseButtons(const YAML::Node& a_node, vector<ButtonBinding>& a_bindings){
+    bool result = true;
+    for (size_t i = 0; i < a_node.size(); i++){
+        YAML::Node actionNode = a_node[i];
+        ButtonBinding binding;
+        string trigger = actionNode["trigger"] ? actionNode["trigger"].as<string>() : "press";
+        string action = actionNode["action"] ? actionNode["action"].as<string>() : "";
+        if (!ButtonActionMapper::parseTrigger(trigger, binding.m_trigger)){
+            cerr << "[ERROR] Unknown button trigger \"" << trigger << "\". It has to be press, release, long press or chord." << endl;
+            result = false;
+            continue;
+        }
+        if (!ButtonActionMapper::parseAction(action, binding.m_action)){
+            cerr << "[ERROR] Unknown button action \"" << action << "\"." << endl;
+            result = false;
+            continue;
+        }
+        for (size_t j = 0; j < actionNode["buttons"].size(); j++){
+            int button = actionNode["buttons"][j].as<int>();
+            if (button < 0 || button >= SPACENAV_MAX_BUTTONS){
+                cerr << "[ERROR] Button " << button << " of \"" << action << "\" is out of range." << endl;
+                result = false;
+                continue;
+            }
+            binding.m_buttons |= 1u << button;
+        }
+        a_bindings.push_back(binding);
+    }
+    return result;
+}
+
+bool SpaceNavConfig::parseParams(const YAML::Node& a_node, const string& a_name, SpaceNavControlParams& a_params){
+    bool result = true;
+
+    if (a_node["scaling"]){
+        vector<double> scale = a_node["scaling"].as<vector<double>>();
+        if (scale.size() == 6){
+            for (int i = 0; i < 6; i++){
+                a_params.m_scale[i] = scale[i];
+            }
+        }
+        else{
+            cerr << "[ERROR] Profile \"" << a_name << "\": the scaling has to be size 6." << endl;
+            result = false;
+        }
+    }
+
+    if (a_node["deadbound"]){
+        if (a_node["deadbound"]["translation"]){
+            double trans_db = a_node["deadbound"]["translation"].as<double>();
+            a_params.m_deadband[0] = a_params.m_deadband[1] = a_params.m_deadband[2] = trans_db;
+        }
+        if (a_node["deadbound"]["rotation"]){
+            double rot_db = a_node["deadbound"]["rotation"].as<double>();
+            a_params.m_deadband[3] = a_params.m_deadband[4] = a_params.m_deadband[5] = rot_db;
+        }
+    }
+
+    if (a_node["curve"]){
+        const char* keys[2] = {"translation", "rotation"};
+        for (int i = 0; i < 2; i++){
+            if (a_node["curve"][keys[i]]){
+                double expo = a_node["curve"][keys[i]].as<double>();
+                if (expo < 0.0 || expo > 1.0){
+                    cerr << "[ERROR] Profile \"" << a_name << "\": the " << keys[i] << " curve has to be in [0, 1]." << endl;
+                    result = false;
+                }
+                else{
+                    a_params.m_expo[i] = expo;
+                }
+            }
+        }
+    }
+
+    if (a_node["velocity scaling"]){
+        if (a_node["velocity scaling"]["linear"]){
+            a_params.m_scaleLinear = a_node["velocity scaling"]["linear"].as<double>();
+        }
+        if (a_node["velocity scaling"]["angular"]){
+            a_params.m_scaleAngular = a_node["velocity scaling"]["angular"].as<double>();
+        }
+    }
+
+    if (a_node["mode"]){
+        string mode = a_node["mode"].as<string>();
+        if (mode == "auto"){
+            a_params.m_mode = SpaceNavControlMode::AUTO;
+        }
+        else if (mode == "force"){
+            a_params.m_mode = SpaceNavControlMode::FORCE;
+        }
+        else if (mode == "velocity"){
+            a_params.m_mode = SpaceNavControlMode::VELOCITY;
+        }
+        else{
+            cerr << "[ERROR] Profile \"" << a_name << "\": unknown mode \"" << mode << "\". It has to be auto, force or velocity." << endl;
+            result = false;
+        }
+    }
+
+    if (a_node["control frame"]){
+        string frame = a_node["control frame"].as<string>();
+        const vector<string> frames = {"default", "world", "camera", "local", "parent", "body"};
+        size_t index = 0;
+        while (index < frames.size() && frames[index] != frame){
+            index++;
+        }
+        if (index < frames.size()){
+            a_params.m_frame = SpaceNavControlFrame(index);
+        }
+        else{
+            cerr << "[ERROR] Profile \"" << a_name << "\": unknown control frame \"" << frame << "\". It has to be default, world, camera, local, parent or body." << endl;
+            result = false;
+        }
+    }
+
+    if (a_node["reference body"]){
+        a_params.m_referenceBody = a_node["reference body"].as<string>();
+    }
+    if (a_params.m_frame == SpaceNavControlFrame::BODY && a_params.m_referenceBody.empty()){
+        cerr << "[ERROR] Profile \"" << a_name << "\": the body control frame needs a reference body." << endl;
+        result = false;
+    }
+
+    if (a_node["pivot"]){
+        vector<double> pivot = a_node["pivot"].as<vector<double>>();
+        if (pivot.size() == 3){
+            for (int i = 0; i < 3; i++){
+                a_params.m_pivot[i] = pivot[i];
+            }
+            a_params.m_usePivot = true;
+        }
+        else{
+            cerr << "[ERROR] Profile \"" << a_name << "\": the pivot has to be size 3." << endl;
+            result = false;
+        }
+    }
+
+    if (a_node["collision sweep"]){
+        YAML::Node sweepNode = a_node["collision sweep"];
+        a_params.m_useSweep = sweepNode["enabled"] ? sweepNode["enabled"].as<bool>() : true;
+        if (sweepNode["radius"]){
+            a_params.m_sweepRadius = sweepNode["radius"].as<double>();
+        }
+        if (sweepNode["margin"]){
+            a_params.m_sweepMargin = sweepNode["margin"].as<double>();
+        }
+        if (a_params.m_sweepRadius <= 0.0 || a_params.m_sweepMargin < 0.0){
+            cerr << "[ERROR] Profile \"" << a_name << "\": the sweep radius has to be positive and the margin not negative." << endl;
+            result = false;
+        }
+    }
+
+    if (a_node["gain scheduling"]){
+        YAML::Node gainNode = a_node["gain scheduling"];
+        a_params.m_useGainScheduling = gainNode["enabled"] ? gainNode["enabled"].as<bool>() : true;
+        if (gainNode["near distance"]){
+            a_params.m_gainNearDistance = gainNode["near distance"].as<double>();
+        }
+        if (gainNode["far distance"]){
+            a_params.m_gainFarDistance = gainNode["far distance"].as<double>();
+        }
+        if (gainNode["min gain"]){
+            a_params.m_gainMin = gainNode["min gain"].as<double>();
+        }
+        if (gainNode["tolerance"]){
+            a_params.m_gainTolerance = gainNode["tolerance"].as<double>();
+        }
+        if (a_params.m_gainNearDistance < 0.0 || a_params.m_gainFarDistance <= a_params.m_gainNearDistance){
+            cerr << "[ERROR] Profile \"" << a_name << "\": the gain scheduling needs 0 <= near distance < far distance." << endl;
+            result = false;
+        }
+        if (a_params.m_gainMin < 0.0 || a_params.m_gainMin > 1.0 || a_params.m_gainTolerance < 0.0){
+            cerr << "[ERROR] Profile \"" << a_name << "\": the min gain has to be in [0, 1] and the tolerance not negative." << endl;
+            result = false;
+        }
+    }
+
+    return result;
+}
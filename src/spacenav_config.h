@@ -0,0 +1,142 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef SPACENAV_CONFIG_H
+#define SPACENAV_CONFIG_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+#include "adaptive_deadband.h"
+#include "button_actions.h"
+
+using namespace std;
+
+// How the motion is applied to a rigid body
+enum class SpaceNavControlMode{
+    AUTO=0, // Use the output type of the controller of the body
+    FORCE=1,
+    VELOCITY=2
+};
+
+// Frame in which the motion of the device is applied
+enum class SpaceNavControlFrame{
+    DEFAULT=0, // Local frame for the cameras, viewing camera for the other objects
+    WORLD=1,
+    CAMERA=2, // Viewing camera
+    LOCAL=3, // The controlled object
+    PARENT=4, // Parent of the controlled object
+    BODY=5 // Named reference body
+};
+
+// Resolved control parameters of one object. Validated at load, used as is in the control loop
+struct SpaceNavControlParams{
+    // Scaling from the device counts [x, y, z, rx, ry, rz]
+    double m_scale[6];
+    // If the motion is less than this value, then we regard it as "static"
+    double m_deadband[6];
+    // Response curve: 0 is linear, 1 is cubic. [translation, rotation]
+    double m_expo[2] = {0.0, 0.0};
+    // Scaling used for moving the rigid bodies
+    double m_scaleLinear = 100.0;
+    double m_scaleAngular = 2.0;
+    SpaceNavControlMode m_mode = SpaceNavControlMode::AUTO;
+    SpaceNavControlFrame m_frame = SpaceNavControlFrame::DEFAULT;
+    string m_referenceBody; // Used with SpaceNavControlFrame::BODY
+    // Rotate about this point instead of the origin of the object. In the local frame of the object
+    bool m_usePivot = false;
+    double m_pivot[3] = {0.0, 0.0, 0.0};
+    // Stop the objects moved by pose at the first contact with a sphere sweep
+    bool m_useSweep = false;
+    double m_sweepRadius = 0.01;
+    double m_sweepMargin = 0.001;
+
+    // Scale the motion down near the surfaces, from 1 at the far distance to the min gain at the near one
+    bool m_useGainScheduling = false;
+    double m_gainNearDistance = 0.01;
+    double m_gainFarDistance = 0.1; // Also the range of the distance queries
+    double m_gainMin = 0.1;
+    double m_gainTolerance = 0.005; // Motion before the distance is queried again
+
+    SpaceNavControlParams();
+};
+
+// One entry of "control objects"
+struct SpaceNavObjectConfig{
+    string m_type; // CAMERA, LIGHT, VOLUME, BODY, JOINT or empty for any type
+    string m_name;
+    string m_profile; // Name of the profile, empty to use the one named after the object
+};
+
+class SpaceNavConfig{
+    public:
+        SpaceNavConfig();
+
+        // Parses and validates the control related part of the config. Returns false on errors
+        bool load(const YAML::Node& a_node);
+
+        // Parameters of an object. Falls back to the default profile
+        const SpaceNavControlParams& getParams(const string& a_objectName, const string& a_profile = "") const;
+
+        static bool parseObject(const YAML::Node& a_node, SpaceNavObjectConfig& a_object);
+
+        vector<SpaceNavObjectConfig> m_objects;
+        SpaceNavControlParams m_defaultParams;
+        map<string, SpaceNavControlParams> m_profiles;
+
+        // Time without events before the device is considered "static" [s]
+        double m_idleTime = 0.1;
+
+        // Deadband on the device counts that follows the noise of the unit
+        AdaptiveDeadbandParams m_adaptiveDeadband;
+
+        // Actions of the buttons. The default bindings are used if none is defined
+        vector<ButtonBinding> m_buttonBindings;
+        double m_longPressTime = 0.8;
+
+    protected:
+        static bool parseButtons(const YAML::Node& a_node, vector<ButtonBinding>& a_bindings);
+        static bool parseParams(const YAML::Node& a_node, const string& a_name, SpaceNavControlParams& a_params);
+};
+
+#endif //SPACENAV_CONFIG_H
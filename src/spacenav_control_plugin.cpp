@@ -73,6 +73,11 @@ int afSpaceNavControlPlugin::init(int argc, char** argv, const afWorldPtr a_afWo
     string file_path = __FILE__;
     m_current_filepath = file_path.substr(0, file_path.rfind("/"));
 
+    MetricsRegistry* metrics = MetricsRegistry::getInstance();
+    m_objectSwitchCount = metrics->getCounter("spacenav_object_switches_total", "Changes of the controlled object");
+    m_sliceCount = metrics->getCounter("spacenav_slices_applied_total", "Changes of the volume slicing applied");
+    m_activeObjectGauge = metrics->getGauge("spacenav_active_object", "Index of the controlled object");
+
     // Initialize Camera
     m_worldPtr = a_afWorld;
     vector<string> cameraNames = {"main_camera", "cameraL", "cameraR", "stereoLR"};
@@ -112,6 +117,45 @@ int afSpaceNavControlPlugin::init(int argc, char** argv, const afWorldPtr a_afWo
         loadControllableObjectsFromWorld();
     }
 
+#ifdef BUILD_WITH_ROS
+    // Publish the ROS messages off the physics thread
+    m_rosPublisher.init(m_rosPublishQueueSize);
+#else
+    // Without ROS, the state is always exported through shared memory
+    // The control still works without it, so a failure is not fatal
+    if (!m_shmExport.isEnabled() && !m_shmExport.init(m_shmName, m_shmSlotCount)){
+        cerr << "ERROR! THE STATE IS NOT EXPORTED. The plugin was built without ROS and the shared memory " << m_shmName << " could not be created." << endl;
+    }
+#endif
+    m_stateClock.start(true);
+
+    // Map the buttons to actions. Without bindings in the config, keep the previous behavior
+    vector<ButtonBinding> bindings = m_config.m_buttonBindings;
+    if (bindings.empty()){
+        bindings = ButtonActionMapper::getDefaultBindings(m_useSingleButton);
+    }
+    if (!m_buttonActions.init(bindings, m_config.m_longPressTime, [this](ButtonAction action, double time){ handleButtonAction(action, time); })){
+        return -1;
+    }
+
+    // Let the other plugins read the state in the process
+    if (m_apiEnabled && !m_apiProvider.init(m_apiName, m_apiSlotCount)){
+        return -1;
+    }
+
+    // The columns of the session log are the objects known at this point
+    if (!m_sessionLogFilepath.empty()){
+        vector<string> names;
+        for (ControllableObject* object: m_controllableObjects){
+            names.push_back(object->name_);
+        }
+        if (!m_sessionLog.open(m_sessionLogFilepath, names, m_sessionLogChunkRows, m_sessionLogQueueSize)){
+            return -1;
+        }
+        m_sessionPoses.resize(names.size());
+        cerr << "INFO! Session log written to " << m_sessionLogFilepath << endl;
+    }
+
     // Initialize Labels
     bool initlabel = initLabels();
     m_num = m_controllableObjects.size();
@@ -194,7 +238,7 @@ bool afSpaceNavControlPlugin::initLabels(){
     m_activeObjectLabel->setText("Warning Panel Test for spaceNav contorl");
 
     m_panelManager.addPanel(m_activeObjectLabel, 0.01, 0.9, PanelReferenceOrigin::LOWER_LEFT, PanelReferenceType::NORMALIZED);
-    m_panelManager.setVisible(m_activeObjectLabel, m_spaceNavControl.m_spanavEnable);
+    m_panelManager.setVisible(m_activeObjectLabel, m_spaceNavControl.isInputEnabled());
 
     // Objects List panel
     m_objectListLabel = new cLabel(font);
@@ -207,7 +251,7 @@ bool afSpaceNavControlPlugin::initLabels(){
     m_objectListLabel->setText("List of Controlable objects");
 
     m_panelManager.addPanel(m_objectListLabel, 0.01, 0.2, PanelReferenceOrigin::LOWER_LEFT, PanelReferenceType::NORMALIZED);
-    m_panelManager.setVisible(m_objectListLabel, m_spaceNavControl.m_spanavEnable);
+    m_panelManager.setVisible(m_objectListLabel, m_spaceNavControl.isInputEnabled());
 
     return true;
 }
@@ -215,20 +259,93 @@ bool afSpaceNavControlPlugin::initLabels(){
 void afSpaceNavControlPlugin::keyboardUpdate(GLFWwindow* a_window, int a_key, int a_scancode, int a_action, int a_mods){ 
     if (a_mods == GLFW_MOD_CONTROL){
         if (a_key == GLFW_KEY_L) {
-            if (m_spaceNavControl.m_spanavEnable){
+            if (m_spaceNavControl.isInputEnabled()){
                 m_enableList = !m_enableList;
                 m_panelManager.setVisible(m_objectListLabel, m_enableList);
             }
         }
+
+        // Cycle through the volume slicing modes. The slicing state belongs to the physics thread
+        else if (a_key == GLFW_KEY_K) {
+            m_keyActions.push(ButtonAction::CYCLE_SLICE_MODE);
+        }
+
+        // Switch between the max and min faces of the crop box
+        else if (a_key == GLFW_KEY_F) {
+            m_keyActions.push(ButtonAction::TOGGLE_CROP_FACES);
+        }
+
+        // Undo and redo the manipulations of the active object
+        else if (a_key == GLFW_KEY_Z) {
+            m_keyActions.push(ButtonAction::UNDO);
+        }
+
+        else if (a_key == GLFW_KEY_Y) {
+            m_keyActions.push(ButtonAction::REDO);
+        }
+
+        else if (a_key == GLFW_KEY_M) {
+            m_keyActions.push(ButtonAction::MARK_POSE);
+        }
+
+        else if (a_key == GLFW_KEY_B) {
+            m_keyActions.push(ButtonAction::RETURN_TO_POSE);
+        }
+
+        // Write the spans recorded so far
+        else if (a_key == GLFW_KEY_T) {
+            if (Tracer::getInstance()->isEnabled()){
+                Tracer::getInstance()->writeChromeTrace(m_traceFilepath);
+            }
+        }
     }
 }
 
 void afSpaceNavControlPlugin::graphicsUpdate(){
+    SPACENAV_TRACE_THREAD_NAME("graphics");
+    SPACENAV_TRACE_SCOPE("afSpaceNavControlPlugin::graphicsUpdate");
+    // Render the cameras at the pose interpolated or predicted for this frame
+    if (!m_cameraFilters.empty()){
+        double time = m_stateClock.getCurrentTimeSeconds();
+        for (auto& it: m_cameraFilters){
+            afCameraPtr camera = it.first;
+            CameraDisplayedPose& displayed = m_displayedPoses[camera];
+
+            // A pose that is not the one written in the last frame was set outside of the plugin
+            // (e.g. with the mouse). Hand it over to the control and keep it until the filter has it
+            cVector3d pos = camera->getLocalPos();
+            cMatrix3d rot = camera->getLocalRot();
+            if (displayed.m_written && (!pos.equals(displayed.m_pos, 1e-9) || !rot.equals(displayed.m_rot, 1e-9))){
+                CameraPoseMove move;
+                move.m_camera = camera;
+                move.m_pos = pos;
+                move.m_rot = rot;
+                if (m_cameraMoves.push(move)){
+                    displayed.m_moveTime = time;
+                }
+                displayed.m_pos = pos;
+                displayed.m_rot = rot;
+                continue;
+            }
+            if (it.second.getResetTime() < displayed.m_moveTime){
+                continue;
+            }
+
+            if (it.second.evaluate(time, pos, rot)){
+                camera->setLocalPos(pos);
+                camera->setLocalRot(rot);
+                displayed.m_pos = pos;
+                displayed.m_rot = rot;
+                displayed.m_written = true;
+            }
+        }
+    }
+
     if (m_activeContorlObject->publishState_ && m_isSendingInfo){
         m_panelManager.setText(m_activeObjectLabel, "Publishing state ...");
     }
     else if (m_activeContorlObject->sliceVolume_ && m_isSlicing){
-        m_panelManager.setText(m_activeObjectLabel, "Slicing VOLUME" + m_activeContorlObject->name_);
+        m_panelManager.setText(m_activeObjectLabel, "Slicing VOLUME " + m_activeContorlObject->name_ + " [" + VolumeManager::getSliceModeName(m_voulmeManager.getCommittedSliceState()) + "]");
     }
     else{
         m_panelManager.setText(m_activeObjectLabel, m_activeContorlObject->name_);
@@ -248,38 +365,76 @@ void afSpaceNavControlPlugin::graphicsUpdate(){
     }
     m_panelManager.setText(m_objectListLabel, list_text);
     m_panelManager.update();
+
+    // Apply the latest slicing state at the frame boundary
+    m_voulmeManager.updateVolume();
 }
 
 void afSpaceNavControlPlugin::physicsUpdate(double dt)
 {
+    SPACENAV_TRACE_THREAD_NAME("physics");
+    SPACENAV_TRACE_SCOPE("afSpaceNavControlPlugin::physicsUpdate");
+    // The control continues from the poses set outside of the plugin on the smoothed cameras
+    CameraPoseMove cameraMove;
+    while (m_cameraMoves.pop(cameraMove)){
+        m_spaceNavControl.detachPose(cameraMove.m_camera, cameraMove.m_pos, cameraMove.m_rot);
+        m_cameraFilters.at(cameraMove.m_camera).reset(m_stateClock.getCurrentTimeSeconds(), cameraMove.m_pos, cameraMove.m_rot);
+    }
+
     // Retrieve SpaceNav current status 
     m_spaceNavControl.measured_jp();
 
-    // Get index from side buttons
-    if (!m_useSingleButton){
-        m_index = (int(m_spaceNavControl.m_buttons[0]/2) - int(m_spaceNavControl.m_buttons[1]/2)) % m_num;
+    // Apply the actions of the buttons pressed since the last step
+    SpaceNavButtonEvent buttonEvent;
+    while (m_spaceNavControl.popButtonEvent(buttonEvent)){
+        m_buttonActions.handleEvent(buttonEvent);
     }
-    else{
-        m_index = (int(m_spaceNavControl.m_buttons[0]/2)) % m_num;
-    }
-
-    // Make sure the index is in the range of [0 - m_num]
-    if (m_index < 0){
-        m_index += m_num;
+    m_buttonActions.update(m_spaceNavControl.getTime());
+    ButtonAction keyAction;
+    while (m_keyActions.pop(keyAction)){
+        handleButtonAction(keyAction, m_spaceNavControl.getTime());
     }
     
     // Select the active control object
+    if (m_controllableObjects[m_index] != m_activeContorlObject){
+        if (m_activeContorlObject){
+            m_objectSwitchCount->increment();
+        }
+        m_activeObjectGauge->set(m_index);
+    }
     m_activeContorlObject = m_controllableObjects[m_index];
+    m_spaceNavControl.setParams(&m_activeContorlObject->params_);
+    m_spaceNavControl.updateFrames(m_activeContorlObject->objectPtr_, m_activeContorlObject->referenceBody_);
 
     // If the slicing is functionality is activated
     if (m_activeContorlObject->sliceVolume_){
-        if (int(m_spaceNavControl.m_buttons[1]/2) % 2 == 1){
+        if (m_sliceEnabled){
             // Get the Max translation value and send the axis and value
             int axis = 0;
             double value = 0;
             m_spaceNavControl.getMaxTransValue(axis, value);
-            m_voulmeManager.sliceVolume(axis, value);
-            m_rosSlicingInterface.publishAxisValue(axis, value);
+
+            bool sliced;
+            if (m_voulmeManager.getSliceMode() == VolumeSliceMode::SYMMETRIC){
+                sliced = m_voulmeManager.sliceVolume(axis, value);
+            }
+            else{
+                cVector3d deltaPos;
+                cMatrix3d deltaRot;
+                m_spaceNavControl.getLocalDelta(m_activeContorlObject->objectPtr_, deltaPos, deltaRot);
+                if (m_voulmeManager.getSliceMode() == VolumeSliceMode::BOX){
+                    sliced = m_voulmeManager.cropVolume(deltaPos);
+                }
+                else{
+                    sliced = m_voulmeManager.moveClipPlane(deltaPos, deltaRot);
+                }
+            }
+            if (sliced){
+                m_sliceCount->increment();
+            }
+#ifdef BUILD_WITH_ROS
+            m_rosPublisher.publishAxisValue(&m_rosSlicingInterface, axis, value);
+#endif
 
             m_isSlicing = true;
         }
@@ -289,12 +444,14 @@ void afSpaceNavControlPlugin::physicsUpdate(double dt)
     }
 
     if (m_activeContorlObject->publishState_){
-        if (int(m_spaceNavControl.m_buttons[1]/2) % 2 == 1){
+        if (m_publishEnabled){
                 // Get the Max translation value and send the axis and value
                 int axis = 0;
                 double value = 0;
                 m_spaceNavControl.getMaxTransValue(axis, value);
-                m_rosInfoInterface.publishAxisValue(axis, value);
+#ifdef BUILD_WITH_ROS
+                m_rosPublisher.publishAxisValue(&m_rosInfoInterface, axis, value);
+#endif
 
                 m_isSendingInfo = true;
         }
@@ -304,6 +461,10 @@ void afSpaceNavControlPlugin::physicsUpdate(double dt)
         }
     }
 
+    if (m_publishDevice){
+        publishDeviceState();
+    }
+
     // If the object is CAMERA
     if(!m_isSendingInfo && m_activeContorlObject->objectPtr_->getType() == afType::CAMERA){
         if(m_activeContorlObject->name_ == "stereo_camera" && m_isStereo){
@@ -329,23 +490,264 @@ void afSpaceNavControlPlugin::physicsUpdate(double dt)
     // else{
     //     m_spaceNavControl.controlObject(m_activeControlObjectPtr);
     // }
+
+    if (!m_cameraFilters.empty()){
+        double time = m_stateClock.getCurrentTimeSeconds();
+        for (auto& it: m_cameraFilters){
+            cVector3d pos;
+            cMatrix3d rot;
+            m_spaceNavControl.getLocalPose(it.first, pos, rot);
+            it.second.record(time, pos, rot);
+        }
+    }
+
+    if (m_poseStream.isEnabled()){
+        recordPose();
+    }
+
+    if (m_poseJournal.isEnabled()){
+        vector<afBaseObjectPtr> objects;
+        getJournaledObjects(m_activeContorlObject, objects);
+        double time = m_stateClock.getCurrentTimeSeconds();
+        for (afBaseObjectPtr object: objects){
+            cVector3d pos;
+            cMatrix3d rot;
+            m_spaceNavControl.getLocalPose(object, pos, rot);
+            m_poseJournal.record(object, pos, rot, time);
+        }
+    }
+
+    if (m_shmExport.isEnabled() || m_apiProvider.isEnabled()){
+        exportState();
+    }
+
+    if (m_sessionLog.isEnabled()){
+        recordSession();
+    }
+}
+
+void afSpaceNavControlPlugin::handleButtonAction(ButtonAction action, double time){
+    switch (action){
+    case ButtonAction::NEXT_OBJECT:
+        if (m_num > 0){
+            m_index = (m_index + 1) % m_num;
+        }
+        break;
+    case ButtonAction::PREVIOUS_OBJECT:
+        if (m_num > 0){
+            m_index = (m_index + m_num - 1) % m_num;
+        }
+        break;
+    case ButtonAction::TOGGLE_SLICE:
+        m_sliceEnabled = !m_sliceEnabled;
+        break;
+    case ButtonAction::TOGGLE_PUBLISH:
+        m_publishEnabled = !m_publishEnabled;
+        break;
+    case ButtonAction::TOGGLE_MODE:
+    {
+        bool enabled = !(m_sliceEnabled || m_publishEnabled);
+        m_sliceEnabled = enabled;
+        m_publishEnabled = enabled;
+        break;
+    }
+    case ButtonAction::CYCLE_SLICE_MODE:
+        if (m_voulmeManager.m_voxelObj){
+            m_voulmeManager.cycleSliceMode();
+            cerr << "INFO! Volume slicing mode: " << VolumeManager::getSliceModeName(m_voulmeManager.m_sliceState) << endl;
+        }
+        break;
+    case ButtonAction::TOGGLE_CROP_FACES:
+        m_voulmeManager.toggleCropFaces();
+        cerr << "INFO! Volume slicing mode: " << VolumeManager::getSliceModeName(m_voulmeManager.m_sliceState) << endl;
+        break;
+    case ButtonAction::UNDO:
+    case ButtonAction::REDO:
+    case ButtonAction::MARK_POSE:
+    case ButtonAction::RETURN_TO_POSE:
+        applyJournalAction(action);
+        break;
+    default:
+        break;
+    }
+}
+
+// The rigid bodies are moved by the dynamics and are not in the journal
+void afSpaceNavControlPlugin::getJournaledObjects(ControllableObject* a_object, vector<afBaseObjectPtr>& a_objects){
+    a_objects.clear();
+    if (!a_object || a_object->objectPtr_->getType() == afType::RIGID_BODY){
+        return;
+    }
+    if (a_object->name_ == "stereo_camera" && m_isStereo){
+        for (afCameraPtr camera: m_stereoCameraPtr){
+            a_objects.push_back(camera);
+        }
+    }
+    else{
+        a_objects.push_back(a_object->objectPtr_);
+    }
+}
+
+void afSpaceNavControlPlugin::applyJournalAction(ButtonAction a_action){
+    if (!m_poseJournal.isEnabled()){
+        cerr << "INFO! The pose journal is not enabled" << endl;
+        return;
+    }
+
+    double time = m_stateClock.getCurrentTimeSeconds();
+    vector<afBaseObjectPtr> objects;
+    getJournaledObjects(m_controllableObjects[m_index], objects);
+    for (afBaseObjectPtr object: objects){
+        cVector3d pos;
+        cMatrix3d rot;
+        bool moved = false;
+        switch (a_action){
+        case ButtonAction::UNDO:
+            moved = m_poseJournal.undo(object, time, pos, rot);
+            break;
+        case ButtonAction::REDO:
+            moved = m_poseJournal.redo(object, time, pos, rot);
+            break;
+        case ButtonAction::MARK_POSE:
+            m_poseJournal.markPose(object);
+            break;
+        case ButtonAction::RETURN_TO_POSE:
+            moved = m_poseJournal.returnToPose(object, time, pos, rot);
+            break;
+        default:
+            break;
+        }
+        if (moved){
+            m_spaceNavControl.setLocalPose(object, pos, rot);
+        }
+    }
+}
+
+void afSpaceNavControlPlugin::exportState(){
+    SpaceNavStateSample sample;
+    sample.m_time = m_stateClock.getCurrentTimeSeconds();
+
+    int buttons[2];
+    m_spaceNavControl.getDeviceState(sample.m_twist, buttons);
+    sample.m_buttons = m_spaceNavControl.getButtonMask();
+
+    sample.m_activeIndex = m_index;
+    strncpy(sample.m_activeName, m_activeContorlObject->name_.c_str(), SPACENAV_STATE_NAME_SIZE - 1);
+
+    sample.m_isSlicing = m_isSlicing;
+    sample.m_isPublishing = m_isSendingInfo;
+    if (m_voulmeManager.m_voxelObj){
+        const VolumeSliceState& state = m_voulmeManager.m_sliceState;
+        sample.m_sliceMode = uint8_t(state.m_mode);
+        sample.m_clipPlaneEnabled = state.m_clipPlane.m_enabled;
+        for (int i = 0; i < 3; i++){
+            sample.m_sliceMinCorner[i] = state.m_minCorner(i);
+            sample.m_sliceMaxCorner[i] = state.m_maxCorner(i);
+            sample.m_clipPlaneNormal[i] = state.m_clipPlane.m_normal(i);
+        }
+        sample.m_clipPlaneOffset = state.m_clipPlane.m_offset;
+    }
+
+    m_shmExport.publish(sample);
+    m_apiProvider.publish(sample);
+}
+
+void afSpaceNavControlPlugin::recordPose(){
+    PoseStreamSample sample;
+    sample.m_time = m_stateClock.getCurrentTimeSeconds();
+
+    cVector3d pos;
+    cMatrix3d rot;
+    m_spaceNavControl.getGlobalPose(m_activeContorlObject->objectPtr_, pos, rot);
+    cQuaternion quat;
+    quat.fromRotMat(rot);
+    for (int i = 0; i < 3; i++){
+        sample.m_pos[i] = pos(i);
+    }
+    sample.m_quat[0] = quat.x;
+    sample.m_quat[1] = quat.y;
+    sample.m_quat[2] = quat.z;
+    sample.m_quat[3] = quat.w;
+
+    int buttons[2];
+    m_spaceNavControl.getDeviceState(sample.m_command, buttons);
+    sample.m_buttons = m_spaceNavControl.getButtonMask();
+
+    if (m_poseStream.record(sample)){
+#ifdef BUILD_WITH_ROS
+        m_rosPublisher.publishPoseBatch(&m_rosPoseInterface, &m_poseStream);
+#endif
+    }
+}
+
+// Only fills the row and the poses. The writing is done on the thread of the log
+void afSpaceNavControlPlugin::recordSession(){
+    SPACENAV_TRACE_SCOPE("afSpaceNavControlPlugin::recordSession");
+    SessionLogRow row;
+    row.m_time = m_stateClock.getCurrentTimeSeconds();
+    double twist[6];
+    int buttons[2];
+    m_spaceNavControl.getDeviceState(twist, buttons);
+    for (int i = 0; i < 6; i++){
+        row.m_command[i] = float(twist[i]);
+    }
+    row.m_buttons = m_spaceNavControl.getButtonMask();
+    row.m_active = m_index;
+
+    for (size_t i = 0; i < m_sessionPoses.size(); i++){
+        cVector3d pos;
+        cMatrix3d rot;
+        m_spaceNavControl.getGlobalPose(m_controllableObjects[i]->objectPtr_, pos, rot);
+        cQuaternion quat;
+        quat.fromRotMat(rot);
+        SessionLogPose& pose = m_sessionPoses[i];
+        for (int j = 0; j < 3; j++){
+            pose.m_pos[j] = pos(j);
+        }
+        pose.m_quat[0] = float(quat.x);
+        pose.m_quat[1] = float(quat.y);
+        pose.m_quat[2] = float(quat.z);
+        pose.m_quat[3] = float(quat.w);
+    }
+    m_sessionLog.record(row, m_sessionPoses.data());
+}
+
+void afSpaceNavControlPlugin::publishDeviceState(){
+    double time = m_devicePublishClock.getCurrentTimeSeconds();
+    if (time - m_lastDevicePublishTime < m_devicePublishPeriod){
+        return;
+    }
+    m_lastDevicePublishTime = time;
+
+    double twist[6];
+    int buttons[2];
+    m_spaceNavControl.getDeviceState(twist, buttons);
+#ifdef BUILD_WITH_ROS
+    m_rosPublisher.publishDeviceState(&m_rosDeviceInterface, twist, buttons);
+#endif
 }
 
 int afSpaceNavControlPlugin::loadConfigurationFile(string spec_filepath){
     //Load the user defined object here. 
     YAML::Node node = YAML::LoadFile(spec_filepath);
     
+    // Parse and validate the control objects and their parameters
+    if (!m_config.load(node)){
+        cerr << "ERROR! INVALID CONFIGURATION FILE " << spec_filepath << endl;
+        return -1;
+    }
+    m_spaceNavControl.m_defaultParams = m_config.m_defaultParams;
+    m_spaceNavControl.m_idleTime = m_config.m_idleTime;
+    m_spaceNavControl.setAdaptiveDeadband(m_config.m_adaptiveDeadband);
+
     // Get contorl objects
-    m_num = node["control objects"].size();
+    m_num = m_config.m_objects.size();
 
     bool isVolume = false;
-    for (size_t i = 0; i < m_num; i++){   
-        string objectName = node["control objects"][i].as<string>();
+    for (const SpaceNavObjectConfig& objectConfig: m_config.m_objects){
+        string objectType = objectConfig.m_type;
+        string objectName = objectConfig.m_name;
         cout << "Looking for the object: \"" << objectName << "\"" << endl;
-        
-        string objectType = objectName.substr(0, objectName.find(" "));
-        objectName = objectName.substr(objectName.find(" "));
-        objectName.erase(0, 1);
 
         // Get object type and the name
         afBaseObjectPtr objectPtr;
@@ -376,6 +778,10 @@ int afSpaceNavControlPlugin::loadConfigurationFile(string spec_filepath){
             ControllableObject* controllableObject = new ControllableObject;
             controllableObject->name_ = objectName;
             controllableObject->objectPtr_ = objectPtr;
+            controllableObject->params_ = m_config.getParams(objectName, objectConfig.m_profile);
+            if (!resolveReferenceBody(controllableObject)){
+                return -1;
+            }
             m_controllableObjects.push_back(controllableObject);
         }
 
@@ -385,44 +791,6 @@ int afSpaceNavControlPlugin::loadConfigurationFile(string spec_filepath){
         }    
     }
 
-    // Get spacenav Parameters
-    if (node["scaling"]){
-        if (node["scaling"].as<std::vector<double>>().size() == 6){
-            m_spaceNavControl.m_scale = node["scaling"].as<std::vector<double>>();
-        }
-        else{
-            cerr << "ERROR in config file. The scaling has to be size 6." << endl;
-        }
-    }
-    
-    if (node["deadbound"]){
-        if (node["deadbound"]["translation"]){
-            double trans_db = node["deadbound"]["translation"].as<double>();
-            m_spaceNavControl.m_deadbound[0] = trans_db;
-            m_spaceNavControl.m_deadbound[1] = trans_db;
-            m_spaceNavControl.m_deadbound[2] = trans_db;
-        }
-        if (node["deadbound"]["rotation"]){
-            double rot_db = node["deadbound"]["rotation"].as<double>();
-            m_spaceNavControl.m_deadbound[3] = rot_db;
-            m_spaceNavControl.m_deadbound[4] = rot_db;
-            m_spaceNavControl.m_deadbound[5] = rot_db;
-        }
-    }
-
-    if (node["static count threshold"]){
-        m_spaceNavControl.m_staticCountThres = node["static count threshold"].as<int>();
-    }
-
-    if (node["velocity scaling"]){
-        if (node["velocity scaling"]["linear"]){
-            m_spaceNavControl.m_scale_linear = node["velocity scaling"]["linear"].as<double>();
-        }
-        if (node["velocity scaling"]["angular"]){
-            m_spaceNavControl.m_scale_angular = node["velocity scaling"]["angular"].as<double>();
-        }
-    }
-
     if(node["stereo_camera"]){
         m_isStereo = true;
         cout << "stereo" << endl;
@@ -433,6 +801,10 @@ int afSpaceNavControlPlugin::loadConfigurationFile(string spec_filepath){
         ControllableObject* controllableObject = new ControllableObject;
         controllableObject->name_ = "stereo_camera";
         controllableObject->objectPtr_ = m_stereoCameraPtr[0];
+        controllableObject->params_ = m_config.getParams("stereo_camera");
+        if (!resolveReferenceBody(controllableObject)){
+            return -1;
+        }
         m_controllableObjects.push_back(controllableObject);
     }
 
@@ -455,7 +827,65 @@ int afSpaceNavControlPlugin::loadConfigurationFile(string spec_filepath){
                                     cerr << "[ERROR] CANNOT INITIALIZE VOLUME MANAGER!!" << endl;
                                     return -1;
                                 }
+                            // Maximum rate [Hz] at which the rendered volume is updated
+                            if (node["slice volume"]["update rate"]){
+                                m_voulmeManager.setUpdateRate(node["slice volume"]["update rate"].as<double>());
+                            }
+                            // Initial slicing mode: symmetric, box or plane
+                            if (node["slice volume"]["mode"]){
+                                string mode = node["slice volume"]["mode"].as<string>();
+                                if (mode == "box"){
+                                    m_voulmeManager.setSliceMode(VolumeSliceMode::BOX);
+                                }
+                                else if (mode == "plane"){
+                                    m_voulmeManager.setSliceMode(VolumeSliceMode::PLANE);
+                                }
+                                else if (mode != "symmetric"){
+                                    cerr << "[ERROR] Unknown slicing mode \"" << mode << "\". Using symmetric." << endl;
+                                }
+                            }
+#ifdef BUILD_WITH_ROS
                             m_rosSlicingInterface.init("/spacenav/VolumeSlicing/");
+
+                            // Stream the cut face as an image
+                            YAML::Node sliceImageNode = node["slice volume"]["slice image"];
+                            if (sliceImageNode){
+                                int width = 256, height = 256, numThreads = 0;
+                                if (sliceImageNode["size"] && sliceImageNode["size"].size() == 2){
+                                    width = sliceImageNode["size"][0].as<int>();
+                                    height = sliceImageNode["size"][1].as<int>();
+                                }
+                                if (sliceImageNode["threads"]){
+                                    numThreads = sliceImageNode["threads"].as<int>();
+                                }
+                                m_rosSlicingInterface.initSliceImage();
+                                RosInterface* rosInterface = &m_rosSlicingInterface;
+                                m_voulmeManager.initSliceImage(numThreads, width, height, [rosInterface](const vector<uint8_t>& image, int w, int h){
+                                    rosInterface->publishSliceImage(image, w, h);
+                                });
+                            }
+
+                            // Statistics of the voxels inside the crop box
+                            YAML::Node statisticsNode = node["slice volume"]["statistics"];
+                            if (statisticsNode){
+                                int threshold = 0, numThreads = 0;
+                                if (statisticsNode["threshold"]){
+                                    threshold = statisticsNode["threshold"].as<int>();
+                                }
+                                if (statisticsNode["threads"]){
+                                    numThreads = statisticsNode["threads"].as<int>();
+                                }
+                                m_rosSlicingInterface.initStatistics();
+                                RosInterface* rosInterface = &m_rosSlicingInterface;
+                                m_voulmeManager.initStatistics(numThreads, threshold, [rosInterface](const VoxelStatistics& statistics){
+                                    rosInterface->publishStatistics(statistics.m_min, statistics.m_max, statistics.m_count, statistics.m_countAboveThreshold, statistics.m_histogram);
+                                });
+                            }
+#else
+                            if (node["slice volume"]["slice image"] || node["slice volume"]["statistics"]){
+                                cerr << "[ERROR] The slice image and the statistics are published on ROS. Build with BUILD_PLUGIN_WITH_ROS to use them." << endl;
+                            }
+#endif
                             m_useSingleButton = true;
                             cerr << "Slicing Volume: " << object->sliceVolume_ << endl;  
                         }
@@ -475,7 +905,9 @@ int afSpaceNavControlPlugin::loadConfigurationFile(string spec_filepath){
         if (node["publish state"]["object"]){
             for (ControllableObject* object: m_controllableObjects){
                 if (object->name_ == node["publish state"]["object"].as<string>()){
+#ifdef BUILD_WITH_ROS
                     m_rosInfoInterface.init("/spacenav/State/");
+#endif
                     object->publishState_ = true;
                     m_useSingleButton = true;
                 }
@@ -483,9 +915,316 @@ int afSpaceNavControlPlugin::loadConfigurationFile(string spec_filepath){
         }
     }
 
+#ifdef BUILD_WITH_ROS
+    // Number of messages buffered for the ROS sender thread
+    if (node["ros publishing"] && node["ros publishing"]["queue size"]){
+        m_rosPublishQueueSize = node["ros publishing"]["queue size"].as<int>();
+        if (m_rosPublishQueueSize <= 0 || size_t(m_rosPublishQueueSize) > SPSC_QUEUE_MAX_CAPACITY){
+            cerr << "[ERROR] The queue size of the ROS publishing has to be between 1 and " << SPSC_QUEUE_MAX_CAPACITY << "." << endl;
+            return -1;
+        }
+    }
+
+    // Take the input from a ROS topic instead of, or merged with, the device
+    if (node["input"]){
+        YAML::Node inputNode = node["input"];
+        string source = inputNode["source"] ? inputNode["source"].as<string>() : "device";
+        string topic = inputNode["topic"] ? inputNode["topic"].as<string>() : "/spacenav/input";
+        string type = inputNode["type"] ? inputNode["type"].as<string>() : "joy";
+        int queueSize = inputNode["queue size"] ? inputNode["queue size"].as<int>() : 256;
+
+        if (source == "topic" || source == "merged"){
+            if (type != "joy" && type != "twist"){
+                cerr << "[ERROR] Unknown input type \"" << type << "\". It has to be joy or twist." << endl;
+                return -1;
+            }
+            if (queueSize <= 0){
+                cerr << "[ERROR] The queue size of the input has to be positive." << endl;
+                return -1;
+            }
+            if (!m_spaceNavControl.setInputSource(source == "topic" ? SpaceNavInputSource::TOPIC : SpaceNavInputSource::MERGED, queueSize)){
+                return -1;
+            }
+            SpaceNavControl* spaceNavControl = &m_spaceNavControl;
+            m_rosInputInterface.initInput(topic, type == "twist", [spaceNavControl](const SpaceNavInputSample& sample){
+                spaceNavControl->pushInput(sample);
+            });
+            cerr << "INFO! Taking the input from " << topic << " (" << source << ")" << endl;
+        }
+        else if (source != "device"){
+            cerr << "[ERROR] Unknown input source \"" << source << "\". It has to be device, topic or merged." << endl;
+            return -1;
+        }
+    }
+
+    // Publish the filtered twist and the buttons of the device
+    if (node["publish device"]){
+        double rate = 0.0;
+        int queueSize = 1;
+        if (node["publish device"]["rate"]){
+            rate = node["publish device"]["rate"].as<double>();
+        }
+        if (node["publish device"]["queue size"]){
+            queueSize = node["publish device"]["queue size"].as<int>();
+        }
+        m_rosDeviceInterface.init("/spacenav/Device/");
+        m_rosDeviceInterface.initDeviceState(queueSize);
+        m_devicePublishPeriod = rate > 0.0 ? 1.0 / rate : 0.0;
+        m_devicePublishClock.start(true);
+        m_publishDevice = true;
+    }
+
+    // Publish the world pose of the active object in batches
+    if (node["pose stream"]){
+        double rate = 50.0;
+        int queueSize = 4096;
+        if (node["pose stream"]["rate"]){
+            rate = node["pose stream"]["rate"].as<double>();
+        }
+        if (node["pose stream"]["queue size"]){
+            queueSize = node["pose stream"]["queue size"].as<int>();
+        }
+        if (rate <= 0.0){
+            cerr << "[ERROR] The rate of the pose stream has to be positive." << endl;
+            return -1;
+        }
+        if (queueSize <= 0 || size_t(queueSize) > SPSC_QUEUE_MAX_CAPACITY){
+            cerr << "[ERROR] The queue size of the pose stream has to be between 1 and " << SPSC_QUEUE_MAX_CAPACITY << "." << endl;
+            return -1;
+        }
+        m_poseStream.init(rate, queueSize);
+        m_rosPoseInterface.init("/spacenav/PoseStream/");
+        m_rosPoseInterface.initPoseStream(m_poseStream.getCapacity());
+    }
+#else
+    if (node["input"] || node["publish device"] || node["pose stream"]){
+        cerr << "[ERROR] The input from a topic, the device publishing and the pose stream need ROS. Build with BUILD_PLUGIN_WITH_ROS to use them." << endl;
+    }
+#endif
+
+    // Smooth the motion of the controlled cameras at render time
+    if (node["camera smoothing"]){
+        YAML::Node smoothingNode = node["camera smoothing"];
+        string mode = smoothingNode["mode"] ? smoothingNode["mode"].as<string>() : "interpolate";
+        double delay = smoothingNode["delay"] ? smoothingNode["delay"].as<double>() : 0.001;
+        double lead = smoothingNode["lead"] ? smoothingNode["lead"].as<double>() : 0.0;
+        double maxExtrapolation = smoothingNode["max extrapolation"] ? smoothingNode["max extrapolation"].as<double>() : 0.05;
+        if (mode != "interpolate" && mode != "predict"){
+            cerr << "[ERROR] Unknown camera smoothing mode \"" << mode << "\". It has to be interpolate or predict." << endl;
+            return -1;
+        }
+        initCameraFilters(mode == "predict" ? CameraPoseMode::PREDICT : CameraPoseMode::INTERPOLATE, delay, lead, maxExtrapolation);
+    }
+
+    // Record the spans of the plugin stages. Enabled before the threads are started
+    if (node["tracing"]){
+        YAML::Node tracingNode = node["tracing"];
+        bool enabled = tracingNode["enabled"] ? tracingNode["enabled"].as<bool>() : true;
+        int bufferSize = tracingNode["buffer size"] ? tracingNode["buffer size"].as<int>() : 65536;
+        if (tracingNode["file"]){
+            m_traceFilepath = tracingNode["file"].as<string>();
+        }
+#ifdef BUILD_WITH_TRACING
+        if (enabled){
+            if (bufferSize <= 0){
+                cerr << "[ERROR] The tracing buffer size has to be positive." << endl;
+                return -1;
+            }
+            Tracer::getInstance()->enable(bufferSize);
+            cerr << "INFO! Tracing enabled. Written to " << m_traceFilepath << " on Ctrl + T and at close" << endl;
+        }
+#else
+        if (enabled){
+            cerr << "[ERROR] Tracing needs the spans. Build with BUILD_PLUGIN_WITH_TRACING to use it." << endl;
+        }
+#endif
+    }
+
+    // Keep the poses of the controlled objects for the undo and the redo
+    if (node["pose journal"]){
+        YAML::Node journalNode = node["pose journal"];
+        bool enabled = journalNode["enabled"] ? journalNode["enabled"].as<bool>() : true;
+        int arenaSize = journalNode["size"] ? journalNode["size"].as<int>() : 262144;
+        int maxUndo = journalNode["max undo"] ? journalNode["max undo"].as<int>() : 1024;
+        double rate = journalNode["rate"] ? journalNode["rate"].as<double>() : 50.0;
+        double gap = journalNode["gap"] ? journalNode["gap"].as<double>() : 0.3;
+        double resolution = journalNode["resolution"] ? journalNode["resolution"].as<double>() : 1e-5;
+        if (arenaSize <= 0 || maxUndo <= 0 || rate <= 0.0 || gap < 0.0 || resolution <= 0.0){
+            cerr << "[ERROR] The size, the max undo, the rate and the resolution of the pose journal have to be positive." << endl;
+            return -1;
+        }
+        if (enabled){
+            m_poseJournal.init(arenaSize, maxUndo, rate, gap, resolution);
+        }
+    }
+
+    // Clamp the device axes and learn the range of the unit. Set before the control thread is started
+    if (node["calibration"]){
+        YAML::Node calibrationNode = node["calibration"];
+        if (calibrationNode["saturation"]){
+            m_spaceNavControl.setSaturation(calibrationNode["saturation"].as<double>());
+        }
+        bool enabled = calibrationNode["enabled"] ? calibrationNode["enabled"].as<bool>() : true;
+        if (enabled){
+            string file = calibrationNode["file"] ? calibrationNode["file"].as<string>() : "";
+            string device = calibrationNode["device"] ? calibrationNode["device"].as<string>() : "spacenav";
+            double nominalRange = calibrationNode["nominal range"] ? calibrationNode["nominal range"].as<double>() : 300.0;
+            double restThreshold = calibrationNode["rest threshold"] ? calibrationNode["rest threshold"].as<double>() : 40.0;
+            double restTime = calibrationNode["rest time"] ? calibrationNode["rest time"].as<double>() : 0.5;
+            double learningRate = calibrationNode["learning rate"] ? calibrationNode["learning rate"].as<double>() : 0.1;
+            if (nominalRange <= 0.0 || learningRate <= 0.0 || learningRate > 1.0){
+                cerr << "[ERROR] The nominal range has to be positive and the learning rate in (0, 1]." << endl;
+                return -1;
+            }
+            m_spaceNavControl.initCalibration(file, device, nominalRange, restThreshold, restTime, learningRate);
+        }
+    }
+
+    // Dump the runtime counters in the Prometheus text format
+    if (node["metrics"]){
+        YAML::Node metricsNode = node["metrics"];
+        string file = metricsNode["file"] ? metricsNode["file"].as<string>() : "spacenav_metrics.prom";
+        double period = metricsNode["period"] ? metricsNode["period"].as<double>() : 10.0;
+        if (!MetricsRegistry::getInstance()->startDump(file, period)){
+            return -1;
+        }
+        cerr << "INFO! Metrics written to " << file << " every " << period << " s" << endl;
+    }
+
+    // Take the input from a device on another machine, streamed by spacenav_udp_sender
+    if (node["network input"]){
+        YAML::Node networkNode = node["network input"];
+        bool enabled = networkNode["enabled"] ? networkNode["enabled"].as<bool>() : true;
+        NetworkInputParams params;
+        if (networkNode["address"]){
+            params.m_address = networkNode["address"].as<string>();
+        }
+        if (networkNode["port"]){
+            params.m_port = networkNode["port"].as<int>();
+        }
+        if (networkNode["min delay"]){
+            params.m_minDelay = networkNode["min delay"].as<double>();
+        }
+        if (networkNode["max delay"]){
+            params.m_maxDelay = networkNode["max delay"].as<double>();
+        }
+        if (networkNode["jitter factor"]){
+            params.m_jitterFactor = networkNode["jitter factor"].as<double>();
+        }
+        if (networkNode["timeout"]){
+            params.m_timeout = networkNode["timeout"].as<double>();
+        }
+        if (networkNode["queue size"]){
+            params.m_queueSize = networkNode["queue size"].as<int>();
+        }
+        if (enabled){
+            if (m_spaceNavControl.getInputSource() != SpaceNavInputSource::DEVICE){
+                cerr << "[ERROR] The network input cannot be combined with the input from a topic." << endl;
+                return -1;
+            }
+            if (!m_spaceNavControl.initNetworkInput(params)){
+                return -1;
+            }
+            cerr << "INFO! Taking the input from the network on " << params.m_address << ":" << params.m_port << endl;
+        }
+    }
+
+    // Poll and filter the input on its own thread at a fixed rate
+    if (node["control thread"]){
+        YAML::Node threadNode = node["control thread"];
+        double rate = threadNode["rate"] ? threadNode["rate"].as<double>() : 1000.0;
+        double nominalRate = threadNode["nominal physics rate"] ? threadNode["nominal physics rate"].as<double>() : 1000.0;
+        int priority = threadNode["priority"] ? threadNode["priority"].as<int>() : 0;
+        if (!m_spaceNavControl.startControlThread(rate, nominalRate, priority)){
+            return -1;
+        }
+        cerr << "INFO! Control thread running at " << rate << " Hz" << endl;
+    }
+
+    // Interface for the other plugins loaded in the simulator
+    if (node["in-process api"]){
+        YAML::Node apiNode = node["in-process api"];
+        m_apiEnabled = apiNode["enabled"] ? apiNode["enabled"].as<bool>() : true;
+        if (apiNode["name"]){
+            m_apiName = apiNode["name"].as<string>();
+        }
+        if (apiNode["slots"]){
+            m_apiSlotCount = apiNode["slots"].as<int>();
+        }
+        if (m_apiSlotCount <= 0){
+            cerr << "[ERROR] The number of slots of the in-process interface has to be positive." << endl;
+            return -1;
+        }
+    }
+
+    // Log of the session for the offline analysis. Opened in init, once the objects are known
+    if (node["session log"]){
+        YAML::Node logNode = node["session log"];
+        bool enabled = logNode["enabled"] ? logNode["enabled"].as<bool>() : true;
+        if (logNode["chunk rows"]){
+            m_sessionLogChunkRows = logNode["chunk rows"].as<int>();
+        }
+        if (logNode["queue size"]){
+            m_sessionLogQueueSize = logNode["queue size"].as<int>();
+        }
+        if (enabled){
+            m_sessionLogFilepath = logNode["file"] ? logNode["file"].as<string>() : "spacenav_session.snlog";
+        }
+    }
+
+    // Export the state through POSIX shared memory. Always enabled when ROS is not available
+    if (node["shared memory"]){
+        if (node["shared memory"]["name"]){
+            m_shmName = node["shared memory"]["name"].as<string>();
+        }
+        if (node["shared memory"]["slots"]){
+            m_shmSlotCount = node["shared memory"]["slots"].as<int>();
+        }
+        if (m_shmSlotCount <= 0){
+            cerr << "[ERROR] The number of slots of the shared memory has to be positive." << endl;
+            return -1;
+        }
+        if (!m_shmExport.init(m_shmName, m_shmSlotCount)){
+            return -1;
+        }
+    }
+
     return 1;
 }
 
+void afSpaceNavControlPlugin::initCameraFilters(CameraPoseMode mode, double delay, double lead, double maxExtrapolation){
+    vector<afCameraPtr> cameras = m_stereoCameraPtr;
+    for (ControllableObject* object: m_controllableObjects){
+        if (object->objectPtr_->getType() == afType::CAMERA && object->name_ != "stereo_camera"){
+            cameras.push_back(afCameraPtr(object->objectPtr_));
+        }
+    }
+    for (afCameraPtr camera: cameras){
+        CameraPoseFilter& filter = m_cameraFilters[camera];
+        filter.init(mode, delay, lead, maxExtrapolation);
+        filter.record(0.0, camera->getLocalPos(), camera->getLocalRot());
+        m_displayedPoses[camera] = CameraDisplayedPose();
+        m_spaceNavControl.detachPose(camera, camera->getLocalPos(), camera->getLocalRot());
+    }
+}
+
+// Find the reference body of the control frame of the object
+bool afSpaceNavControlPlugin::resolveReferenceBody(ControllableObject* object){
+    if (object->params_.m_frame != SpaceNavControlFrame::BODY){
+        return true;
+    }
+    string bodyName = object->params_.m_referenceBody;
+    object->referenceBody_ = m_worldPtr->getRigidBody(bodyName);
+    if (!object->referenceBody_){
+        object->referenceBody_ = m_worldPtr->getBaseObject(bodyName, m_worldPtr->getChildrenMap());
+    }
+    if (!object->referenceBody_){
+        cerr << "ERROR! COULD NOT FIND THE REFERENCE BODY \"" << bodyName << "\" OF \"" << object->name_ << "\"" << endl;
+        return false;
+    }
+    return true;
+}
+
 int afSpaceNavControlPlugin::loadControllableObjectsFromWorld(){
     // Load every Model/Object in the world
     // ModelMap: map<string, afModelPtr>
@@ -516,6 +1255,27 @@ void afSpaceNavControlPlugin::reset(){
 bool afSpaceNavControlPlugin::close(){
     delete m_activeObjectLabel;
     delete m_objectListLabel;
+    m_voulmeManager.close();
+#ifdef BUILD_WITH_ROS
+    m_rosPublisher.close();
+#endif
+    if (m_poseStream.isEnabled()){
+        cerr << "INFO! Pose stream: " << m_poseStream.getDroppedCount() << " samples dropped" << endl;
+    }
+    if (m_poseJournal.isEnabled()){
+        cerr << "INFO! Pose journal: " << m_poseJournal.getMemoryUsage() << " bytes" << endl;
+    }
+    m_sessionLog.close();
+    m_shmExport.close();
+    m_apiProvider.close();
+#ifdef BUILD_WITH_ROS
+    m_rosInputInterface.close();
+#endif
     m_spaceNavControl.close();
+    MetricsRegistry::getInstance()->stopDump();
+    if (Tracer::getInstance()->isEnabled()){
+        Tracer::getInstance()->writeChromeTrace(m_traceFilepath);
+        Tracer::getInstance()->disable();
+    }
     return -1;
 }
@@ -44,13 +44,26 @@
 #include <afFramework.h>
 
 #include "camera_panel_manager.h"
+#include "camera_pose_filter.h"
 
+#include "spacenav_config.h"
 #include "spacenav_manager.h"
 #include "volume_manager.h"
 #include <yaml-cpp/yaml.h>
 
 #include <boost/program_options.hpp>
+#include "shm_state_export.h"
+#include "spacenav_api_provider.h"
+#include "metrics.h"
+#include "pose_journal.h"
+#include "pose_stream.h"
+#include "session_log.h"
+#include "tracer.h"
+
+#ifdef BUILD_WITH_ROS
 #include "ros_interface.h"
+#include "ros_publish_thread.h"
+#endif
 
 namespace boost{
     namespace program_options{
@@ -63,11 +76,28 @@ namespace p_opt = boost::program_options;
 using namespace std;
 using namespace ambf;
 
+// Pose of a smoothed camera set outside of the plugin, handed over to the physics thread
+struct CameraPoseMove{
+    afCameraPtr m_camera = nullptr;
+    cVector3d m_pos;
+    cMatrix3d m_rot;
+};
+
+// Pose of a smoothed camera written in the last frame. Graphics thread
+struct CameraDisplayedPose{
+    cVector3d m_pos;
+    cMatrix3d m_rot;
+    bool m_written = false;
+    double m_moveTime = -1.0; // Time of the latest move set outside of the plugin
+};
+
 struct ControllableObject{
     string name_;
     afBaseObjectPtr objectPtr_;
     bool sliceVolume_ = false;
     bool publishState_ = false;
+    SpaceNavControlParams params_;
+    afBaseObjectPtr referenceBody_ = nullptr;
 };
 
 class afSpaceNavControlPlugin: public afSimulatorPlugin{
@@ -86,7 +116,17 @@ class afSpaceNavControlPlugin: public afSimulatorPlugin{
         bool changeCamera(afCameraPtr cameraPtr);
         int loadConfigurationFile(string spec_filepath);
         int loadControllableObjectsFromWorld();
+        bool resolveReferenceBody(ControllableObject* object);
         void updateButtons();
+        void publishDeviceState();
+        void exportState();
+        void handleButtonAction(ButtonAction action, double time);
+        void recordPose();
+        void recordSession();
+        // Objects moved by the pose when a_object is controlled (e.g. both cameras of a stereo pair)
+        void getJournaledObjects(ControllableObject* a_object, vector<afBaseObjectPtr>& a_objects);
+        void applyJournalAction(ButtonAction a_action);
+        void initCameraFilters(CameraPoseMode mode, double delay, double lead, double maxExtrapolation);
 
     // private:
         // Pointer to the world
@@ -106,10 +146,12 @@ class afSpaceNavControlPlugin: public afSimulatorPlugin{
 
         // Controllable object
         vector<ControllableObject*> m_controllableObjects;
-        ControllableObject* m_activeContorlObject;
+        ControllableObject* m_activeContorlObject = nullptr;
 
         // SpaceNav related
         SpaceNavControl m_spaceNavControl;
+        SpaceNavConfig m_config;
+        ButtonActionMapper m_buttonActions;
 
         // Number of object
         int m_num = 0;
@@ -126,12 +168,73 @@ class afSpaceNavControlPlugin: public afSimulatorPlugin{
         // Volume related
         VolumeManager m_voulmeManager;
         string m_volumeName;
-        bool m_useSingleButton = false;
+        bool m_useSingleButton = false; // Selects the default button bindings
+        bool m_sliceEnabled = false;
+        bool m_publishEnabled = false;
         bool m_isSlicing = false;
         bool m_isSendingInfo = false;
+
+#ifdef BUILD_WITH_ROS
         RosInterface m_rosSlicingInterface;
         RosInterface m_rosInfoInterface;
 
+        // Sender thread for the ROS messages published from the physics thread
+        RosPublishThread m_rosPublisher;
+        int m_rosPublishQueueSize = 1024;
+
+        // External input
+        RosInterface m_rosInputInterface;
+
+        // Device state publishing
+        RosInterface m_rosDeviceInterface;
+
+        // Pose stream of the active object
+        RosInterface m_rosPoseInterface;
+#endif
+        PoseStream m_poseStream;
+        bool m_publishDevice = false;
+        double m_devicePublishPeriod = 0.0; // 0 means every physics tick
+        double m_lastDevicePublishTime = 0.0;
+        cPrecisionClock m_devicePublishClock;
+
+        // Poses of the controlled cameras evaluated at render time. Not modified after init.
+        // Only the graphics thread writes these cameras, the control moves their detached poses
+        map<afCameraPtr, CameraPoseFilter> m_cameraFilters;
+        map<afCameraPtr, CameraDisplayedPose> m_displayedPoses;
+        SpscQueue<CameraPoseMove> m_cameraMoves{64};
+
+        // History of the poses of the controlled objects for the undo and the redo
+        PoseJournal m_poseJournal;
+        // Actions of the keys, applied in the physics thread
+        SpscQueue<ButtonAction> m_keyActions{16};
+
+        // Shared memory export of the state
+        ShmStateExport m_shmExport;
+        string m_shmName = "/spacenav_state";
+        int m_shmSlotCount = 64;
+
+        // State for the other plugins of the process
+        SpaceNavApiProvider m_apiProvider;
+        string m_apiName = "spacenav";
+        int m_apiSlotCount = 64;
+        bool m_apiEnabled = true;
+        cPrecisionClock m_stateClock;
+
+        // Columnar log of the commands and the poses of all the controllable objects
+        SessionLog m_sessionLog;
+        vector<SessionLogPose> m_sessionPoses;
+        string m_sessionLogFilepath;
+        int m_sessionLogChunkRows = 1024;
+        int m_sessionLogQueueSize = 4096;
+
+        // Chrome trace written on Ctrl + T and at close
+        string m_traceFilepath = "spacenav_trace.json";
+
+        // Runtime counters, owned by the metrics registry
+        MetricCounter* m_objectSwitchCount;
+        MetricCounter* m_sliceCount;
+        MetricGauge* m_activeObjectGauge;
+
 
 
 };
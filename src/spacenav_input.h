@@ -0,0 +1,66 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+#ifndef SPACENAV_INPUT_H
+#define SPACENAV_INPUT_H
+
+// Full scale of the spacenav axes in raw device counts
+#define SPACENAV_FULL_SCALE 512.0
+
+// Maximum number of buttons carried by an input sample
+#define SPACENAV_MAX_BUTTONS 16
+
+enum class SpaceNavInputSource{
+    DEVICE=0, // Local device through spacenavd
+    TOPIC=1, // Samples pushed from a ROS topic
+    MERGED=2, // Both. The last sample received wins
+    NETWORK=3 // Remote device streamed over UDP
+};
+
+// One sample of an external input, in the raw device axes and counts
+struct SpaceNavInputSample{
+    double m_axes[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0}; // [x, y, z, rx, ry, rz]
+    unsigned int m_buttons = 0; // Bit i is set while button i is pressed
+    bool m_hasMotion = false;
+    bool m_hasButtons = false;
+};
+
+#endif //SPACENAV_INPUT_H
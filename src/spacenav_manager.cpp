@@ -41,11 +41,22 @@
 //==============================================================================
 
 #include "spacenav_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <pthread.h>
+#include <sched.h>
 
 using namespace std;
 
 SpaceNavControl::SpaceNavControl(){
-
+    MetricsRegistry* metrics = MetricsRegistry::getInstance();
+    m_motionEventCount = metrics->getCounter("spacenav_events_total", "Events received from the device", "type=\"motion\"");
+    m_buttonEventCount = metrics->getCounter("spacenav_events_total", "Events received from the device", "type=\"button\"");
+    m_inputSampleCount = metrics->getCounter("spacenav_input_samples_total", "Samples received from the input topic");
+    m_saturatedEventCount = metrics->getCounter("spacenav_saturated_events_total", "Motion events with an axis clamped by the saturation limit");
+    m_deadbandTransCount = metrics->getCounter("spacenav_deadband_zeroed_total", "Idle polls where the deadband zeroed the motion", "axes=\"translation\"");
+    m_deadbandRotCount = metrics->getCounter("spacenav_deadband_zeroed_total", "Idle polls where the deadband zeroed the motion", "axes=\"rotation\"");
+    m_idlePollCount = metrics->getCounter("spacenav_idle_polls_total", "Polls of the device without any event");
 }
 
 // Rotate the camera
@@ -57,26 +68,27 @@ int SpaceNavControl::init(afWorldPtr a_afWorld, afCameraPtr &a_camera)
     // Define the camera
     m_camera = a_camera;
    
-    // Set the scaling 
-    // TODO: Hardcoded now 
-    double full_scale = 0.001 / 512.0;
-    m_scale = {0.5 * full_scale, 0.5 * full_scale, 0.5 * full_scale, 50.0 * full_scale, 50.0 *full_scale, 50.0 *full_scale};
-
-    double trans_db = 0.1;
-    double rot_db = 0.1;
-    m_deadbound = {trans_db, trans_db, trans_db, rot_db, rot_db, rot_db};
-
-    // The number of polls needed to be done before the device is considered "static"
-    m_staticCountThres = 100;
-
-    // Scaling used for moving the rigid body
-    m_scale_linear = 100.0;
-    m_scale_angular = 2.0;
+    // Default parameters until the ones of the active object are set
+    m_params = &m_defaultParams;
+    m_deviceParams = &m_defaultParams;
+    m_sharedParams.store(&m_defaultParams);
+    m_frames.m_cameraRot = m_camera->getLocalRot();
+    m_sweeper.init(m_worldPtr->m_bulletWorld);
+    m_proximity.init(m_worldPtr->m_bulletWorld);
 
     // Initialize the value
     m_trans.set(0,0,0);
     m_rot.set(0,0,0);
-    m_buttons = {0.0, 0.0};
+    m_velTrans.set(0,0,0);
+    m_velRot.set(0,0,0);
+    for (int i = 0; i < 6; i++){
+        m_raw[i] = 0.0;
+        m_deviceTwist[i] = 0.0;
+        m_lastIntegrated[i] = 0.0;
+    }
+    m_buttonMask = 0;
+    m_deviceButtonMask = 0;
+    m_startTime = chrono::steady_clock::now();
 
     int result = spnav_open();
 
@@ -92,120 +104,703 @@ int SpaceNavControl::init(afWorldPtr a_afWorld, afCameraPtr &a_camera)
     return 1;
 }
 
+// Update the motion of the current physics step. Call once per step
 int SpaceNavControl::measured_jp()
 {   
-    if (m_spanavEnable){
-        switch (spnav_poll_event(&sev))
-        {
-        case 0:
-            if (++m_noMotion > m_staticCountThres){
-
-                if (fabs(m_trans.x()) < m_deadbound[0] && \
-                fabs(m_trans.y()) < m_deadbound[1] && \
-                fabs(m_trans.z()) < m_deadbound[2])
-                {
-                    m_trans.set(0.0, 0.0, 0.0);
-                }
-
-                if (fabs(m_rot.x()) < m_deadbound[3] && \
-                fabs(m_rot.y()) < m_deadbound[4] && \
-                fabs(m_rot.z()) < m_deadbound[5])
-                {
-                    m_rot.set(0.0, 0.0, 0.0);
-                } 
-            }
-            m_noMotion = 0;
-            break;
+    SPACENAV_TRACE_SCOPE("SpaceNavControl::measured_jp");
+    if (m_controlThread.joinable()){
+        return readDeviceState();
+    }
 
-        case SPNAV_EVENT_MOTION:
+    m_deviceParams = m_params;
+    m_measuredResult = pollInputs();
+    for (int i = 0; i < 3; i++){
+        m_trans(i) = m_deviceTwist[i];
+        m_rot(i) = m_deviceTwist[3 + i];
+    }
+    m_velTrans = m_trans;
+    m_velRot = m_rot;
+    m_buttonMask = m_deviceButtonMask;
+    return m_measuredResult;
+}
 
-            if (abs(sev.motion.z < 510) && abs(sev.motion.x < 510) && abs(sev.motion.y < 510) && abs(sev.motion.rz < 510 && abs(sev.motion.rx < 510)) && abs(sev.motion.ry < 510)){
-                m_trans.set(-sev.motion.z  * m_scale[0], sev.motion.x * m_scale[1], sev.motion.y  * m_scale[2]);
-                m_rot.set(sev.motion.rz * m_scale[3], -sev.motion.rx * m_scale[4], sev.motion.ry* m_scale[5]);
-            }
+// Poll the device and the external input, and compute the twist
+int SpaceNavControl::pollInputs()
+{
+    int result = -1;
+    if (m_spanavEnable && (m_inputSource == SpaceNavInputSource::DEVICE || m_inputSource == SpaceNavInputSource::MERGED)){
+        result = pollDevice();
+        if (result == -1){
+            return -1;
+        }
+    }
+
+    if (m_inputSource == SpaceNavInputSource::NETWORK){
+        pollNetworkInput();
+        result = 1;
+    }
+    else if (m_inputSource != SpaceNavInputSource::DEVICE){
+        pollInputQueue();
+        result = 1;
+    }
 
-            break;
-        
-        case SPNAV_EVENT_BUTTON:
-            m_buttons[sev.button.bnum]++;
+    computeTwist();
+    return result;
+}
 
-            break;
-            
-        default:
+int SpaceNavControl::pollDevice()
+{
+    // Handle every pending event
+    int numEvents = 0;
+    int type;
+    while ((type = spnav_poll_event(&sev)) != 0){
+        numEvents++;
+        if (type == SPNAV_EVENT_MOTION){
+            m_motionEventCount->increment();
+            double raw[6] = {double(sev.motion.x), double(sev.motion.y), double(sev.motion.z),
+                             double(sev.motion.rx), double(sev.motion.ry), double(sev.motion.rz)};
+            double counts[6];
+            if (m_calibrator.process(raw, getTime(), counts) > 0){
+                m_saturatedEventCount->increment();
+            }
+            m_adaptiveDeadband.filter(counts, counts);
+            applyMotion(counts);
+            m_motionSource = &m_deviceIdle;
+        }
+        else if (type == SPNAV_EVENT_BUTTON){
+            m_buttonEventCount->increment();
+            applyButton(sev.button.bnum, sev.button.press != 0);
+        }
+        else{
             cerr << "Unknown message type in spacenav. This should never happen." << endl;
             return -1;
-            break;
         }
-        return 1;
+    }
+    double time = getTime();
+    m_calibrator.update(time);
+    if (numEvents > 0){
+        m_deviceIdle.m_lastEventTime = time;
+        m_deviceIdle.m_idleApplied = false;
+    }
+    else{
+        m_idlePollCount->increment();
+        applyIdleDeadband(m_deviceIdle, time);
+    }
+    return 1;
+}
+
+// The device is static after some time without events, whatever the polling rate.
+// Remove the small motion it was left with, if this source set the current motion
+void SpaceNavControl::applyIdleDeadband(SpaceNavIdleState& a_state, double a_time)
+{
+    if (a_state.m_idleApplied || a_time - a_state.m_lastEventTime <= m_idleTime){
+        return;
+    }
+    a_state.m_idleApplied = true;
+    if (m_motionSource != &a_state){
+        return;
+    }
+    computeTwist();
+    if (fabs(m_deviceTwist[0]) < m_deviceParams->m_deadband[0] && \
+    fabs(m_deviceTwist[1]) < m_deviceParams->m_deadband[1] && \
+    fabs(m_deviceTwist[2]) < m_deviceParams->m_deadband[2])
+    {
+        m_raw[0] = m_raw[1] = m_raw[2] = 0.0;
+        m_deadbandTransCount->increment();
     }
 
-    return -1;
+    if (fabs(m_deviceTwist[3]) < m_deviceParams->m_deadband[3] && \
+    fabs(m_deviceTwist[4]) < m_deviceParams->m_deadband[4] && \
+    fabs(m_deviceTwist[5]) < m_deviceParams->m_deadband[5])
+    {
+        m_raw[3] = m_raw[4] = m_raw[5] = 0.0;
+        m_deadbandRotCount->increment();
+    }
+}
+
+// Store the raw device counts [x, y, z, rx, ry, rz]
+void SpaceNavControl::applyMotion(const double* raw)
+{
+    SPACENAV_TRACE_INSTANT("spacenav motion event");
+    // Each axis is clamped on its own, so a full deflection keeps moving at the full speed
+    for (int i = 0; i < 6; i++){
+        m_raw[i] = cClamp(raw[i], -SPACENAV_FULL_SCALE, SPACENAV_FULL_SCALE);
+    }
+}
+
+// Scale the raw device counts into the motion of the objects with the active parameters
+void SpaceNavControl::computeTwist()
+{
+    double value[6];
+    for (int i = 0; i < 6; i++){
+        // Blend of a linear and a cubic response on the normalized value
+        double expo = m_deviceParams->m_expo[i / 3];
+        double x = m_raw[i] / SPACENAV_FULL_SCALE;
+        value[i] = ((1.0 - expo) * x + expo * x * x * x) * SPACENAV_FULL_SCALE;
+    }
+    const double* scale = m_deviceParams->m_scale;
+    m_deviceTwist[0] = -value[2] * scale[0];
+    m_deviceTwist[1] = value[0] * scale[1];
+    m_deviceTwist[2] = value[1] * scale[2];
+    m_deviceTwist[3] = value[5] * scale[3];
+    m_deviceTwist[4] = -value[3] * scale[4];
+    m_deviceTwist[5] = value[4] * scale[5];
+}
+
+void SpaceNavControl::setParams(const SpaceNavControlParams* a_params)
+{
+    m_params = a_params ? a_params : &m_defaultParams;
+    m_sharedParams.store(m_params, memory_order_release);
+}
+
+// Keep the state of the button and queue the edge with its arrival time
+void SpaceNavControl::applyButton(int bnum, bool pressed)
+{
+    SPACENAV_TRACE_INSTANT("spacenav button event");
+    if (bnum < 0 || bnum >= SPACENAV_MAX_BUTTONS){
+        return;
+    }
+    if (pressed){
+        m_deviceButtonMask |= 1u << bnum;
+    }
+    else{
+        m_deviceButtonMask &= ~(1u << bnum);
+    }
+
+    SpaceNavButtonEvent event;
+    event.m_button = bnum;
+    event.m_pressed = pressed;
+    event.m_time = getTime();
+    if (!m_buttonEvents.push(event)){
+        cerr << "ERROR! SpaceNav button event dropped. The button events are not handled." << endl;
+    }
+}
+
+void SpaceNavControl::initCalibration(const string& a_filepath, const string& a_device, double a_nominalRange,
+                                      double a_restThreshold, double a_restTime, double a_learningRate)
+{
+    m_calibrator.enable(a_nominalRange, a_restThreshold, a_restTime, a_learningRate);
+    m_calibrationFilepath = a_filepath;
+    m_calibrationDevice = a_device;
+    if (!m_calibrationFilepath.empty()){
+        m_calibrator.load(m_calibrationFilepath, m_calibrationDevice);
+    }
+}
+
+double SpaceNavControl::getTime()
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - m_startTime).count();
+}
+
+bool SpaceNavControl::setInputSource(SpaceNavInputSource a_source, int a_queueSize)
+{
+    if (a_queueSize <= 0 || !m_inputQueue.init(size_t(a_queueSize))){
+        cerr << "[ERROR] The queue size of the input has to be between 1 and " << SPSC_QUEUE_MAX_CAPACITY << "." << endl;
+        return false;
+    }
+    m_inputButtons = 0;
+    fill(m_inputAxes, m_inputAxes + 6, 0.0);
+    m_inputSource = a_source;
+    return true;
+}
+
+// Called from the thread that receives the external input
+bool SpaceNavControl::pushInput(const SpaceNavInputSample& a_sample)
+{
+    if (!m_inputQueue.push(a_sample)){
+        m_inputDropped++;
+        return false;
+    }
+    return true;
+}
+
+void SpaceNavControl::pollInputQueue()
+{
+    double time = getTime();
+    SpaceNavInputSample sample;
+    while (m_inputQueue.pop(sample)){
+        m_inputSampleCount->increment();
+        filterInputSample(sample, time);
+        applyInputSample(sample);
+    }
+    // Already updated by pollDevice when the device is polled too
+    if (!m_spanavEnable || m_inputSource != SpaceNavInputSource::MERGED){
+        m_calibrator.update(time);
+    }
+    applyIdleDeadband(m_inputIdle, time);
+}
+
+// The external samples are raw device counts, filtered as the ones of the local device.
+// A topic or the network sender may repeat the last motion at its rate while the device
+// only reports changes, so only a changed motion is an event for the idle deadband
+void SpaceNavControl::filterInputSample(SpaceNavInputSample& a_sample, double a_time)
+{
+    if (!a_sample.m_hasMotion){
+        return;
+    }
+    if (equal(a_sample.m_axes, a_sample.m_axes + 6, m_inputAxes)){
+        a_sample.m_hasMotion = false;
+        return;
+    }
+    copy(a_sample.m_axes, a_sample.m_axes + 6, m_inputAxes);
+    m_inputIdle.m_lastEventTime = a_time;
+    m_inputIdle.m_idleApplied = false;
+    m_motionSource = &m_inputIdle;
+    double counts[6];
+    if (m_calibrator.process(a_sample.m_axes, a_time, counts) > 0){
+        m_saturatedEventCount->increment();
+    }
+    m_adaptiveDeadband.filter(counts, a_sample.m_axes);
+}
+
+bool SpaceNavControl::initNetworkInput(const NetworkInputParams& a_params)
+{
+    if (!m_networkInput.open(a_params)){
+        return false;
+    }
+    m_inputButtons = 0;
+    fill(m_inputAxes, m_inputAxes + 6, 0.0);
+    m_inputSource = SpaceNavInputSource::NETWORK;
+    return true;
+}
+
+void SpaceNavControl::pollNetworkInput()
+{
+    double time = getTime();
+    SpaceNavInputSample sample;
+    while (m_networkInput.pop(sample)){
+        filterInputSample(sample, time);
+        applyInputSample(sample);
+    }
+    m_calibrator.update(time);
+    applyIdleDeadband(m_inputIdle, time);
+}
+
+void SpaceNavControl::applyInputSample(const SpaceNavInputSample& a_sample)
+{
+    if (a_sample.m_hasMotion){
+        applyMotion(a_sample.m_axes);
+    }
+
+    // The samples carry the button states, turn the changes into press/release events
+    if (a_sample.m_hasButtons){
+        unsigned int changed = a_sample.m_buttons ^ m_inputButtons;
+        for (int i = 0; i < SPACENAV_MAX_BUTTONS; i++){
+            if (changed & (1u << i)){
+                applyButton(i, (a_sample.m_buttons >> i) & 1u);
+            }
+        }
+        m_inputButtons = a_sample.m_buttons;
+    }
+}
+
+// Poll and filter the device at a fixed rate, independently of the physics
+bool SpaceNavControl::startControlThread(double a_rate, double a_nominalRate, int a_priority)
+{
+    if (a_rate <= 0.0 || a_nominalRate <= 0.0){
+        cerr << "[ERROR] The rates of the control thread have to be positive." << endl;
+        return false;
+    }
+    stopControlThread();
+    m_controlPeriod = 1.0 / a_rate;
+    m_nominalRate = a_nominalRate;
+    m_controlPriority = a_priority;
+    m_loopCount = 0;
+    m_loopOverruns = 0;
+    m_loopJitterSum = 0.0;
+    m_loopMaxJitter = 0.0;
+    m_controlRunning = true;
+    m_controlThread = thread(&SpaceNavControl::controlLoop, this);
+    return true;
+}
+
+void SpaceNavControl::stopControlThread()
+{
+    if (!m_controlThread.joinable()){
+        return;
+    }
+    m_controlRunning = false;
+    m_controlThread.join();
+
+    SpaceNavLoopStats stats = getLoopStats();
+    cerr << "INFO! Control thread: " << stats.m_count << " loops, " << stats.m_overruns << " overruns, jitter mean "
+         << stats.m_meanJitter * 1e6 << " us, max " << stats.m_maxJitter * 1e6 << " us" << endl;
+}
+
+SpaceNavLoopStats SpaceNavControl::getLoopStats()
+{
+    SpaceNavLoopStats stats;
+    stats.m_count = m_loopCount.load();
+    stats.m_overruns = m_loopOverruns.load();
+    stats.m_meanJitter = stats.m_count > 0 ? m_loopJitterSum.load() / stats.m_count : 0.0;
+    stats.m_maxJitter = m_loopMaxJitter.load();
+    return stats;
+}
+
+void SpaceNavControl::controlLoop()
+{
+    SPACENAV_TRACE_THREAD_NAME("spacenav control");
+    if (m_controlPriority > 0){
+        sched_param param;
+        param.sched_priority = m_controlPriority;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0){
+            cerr << "INFO! Could not set the real-time priority of the control thread. Running with the default scheduling." << endl;
+        }
+    }
+
+    typedef chrono::steady_clock clock;
+    const clock::duration period = chrono::duration_cast<clock::duration>(chrono::duration<double>(m_controlPeriod));
+    const clock::time_point start = clock::now();
+    clock::time_point deadline = start;
+    clock::time_point last = start;
+    double integrated[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+    while (m_controlRunning.load(memory_order_relaxed)){
+        clock::time_point now = clock::now();
+        double dt = chrono::duration<double>(now - last).count();
+        last = now;
+
+        m_deviceParams = m_sharedParams.load(memory_order_acquire);
+        int result;
+        {
+            SPACENAV_TRACE_SCOPE("SpaceNavControl::pollInputs");
+            result = pollInputs();
+        }
+
+        // Integrate in nominal physics steps, so that the motion keeps its speed if the physics slows down
+        SpaceNavDeviceState& state = m_deviceState.getWriteBuffer();
+        for (int i = 0; i < 6; i++){
+            integrated[i] += m_deviceTwist[i] * dt * m_nominalRate;
+            state.m_twist[i] = m_deviceTwist[i];
+            state.m_integrated[i] = integrated[i];
+        }
+        state.m_buttonMask = m_deviceButtonMask;
+        state.m_result = result;
+        state.m_time = chrono::duration<double>(now - start).count();
+        m_deviceState.publish();
+
+        // Lateness of the wake up
+        double jitter = chrono::duration<double>(now - deadline).count();
+        m_loopCount.store(m_loopCount.load(memory_order_relaxed) + 1, memory_order_relaxed);
+        m_loopJitterSum.store(m_loopJitterSum.load(memory_order_relaxed) + fabs(jitter), memory_order_relaxed);
+        if (fabs(jitter) > m_loopMaxJitter.load(memory_order_relaxed)){
+            m_loopMaxJitter.store(fabs(jitter), memory_order_relaxed);
+        }
+
+        // Sleep until an absolute deadline so that the errors do not accumulate.
+        // The missed periods are skipped instead of run back to back
+        deadline += period;
+        now = clock::now();
+        if (now > deadline){
+            long missed = long((now - deadline) / period) + 1;
+            m_loopOverruns.store(m_loopOverruns.load(memory_order_relaxed) + missed, memory_order_relaxed);
+            deadline += period * missed;
+        }
+        this_thread::sleep_until(deadline);
+    }
+}
+
+// Take the latest state from the control thread
+int SpaceNavControl::readDeviceState()
+{
+    m_deviceState.update();
+    const SpaceNavDeviceState& state = m_deviceState.getReadBuffer();
+    for (int i = 0; i < 3; i++){
+        m_trans(i) = state.m_integrated[i] - m_lastIntegrated[i];
+        m_rot(i) = state.m_integrated[3 + i] - m_lastIntegrated[3 + i];
+        m_velTrans(i) = state.m_twist[i];
+        m_velRot(i) = state.m_twist[3 + i];
+    }
+    for (int i = 0; i < 6; i++){
+        m_lastIntegrated[i] = state.m_integrated[i];
+    }
+    m_buttonMask = state.m_buttonMask;
+    m_measuredResult = state.m_result;
+    return m_measuredResult;
+}
+
+// Frames of the object in the current tick, computed once in updateFrames
+void SpaceNavControl::updateFrames(afBaseObjectPtr a_object, afBaseObjectPtr a_referenceBody)
+{
+    m_referenceBody = a_referenceBody;
+    computeFrames(a_object, m_frames);
+    m_gain = computeGain(a_object);
+}
+
+// Fine motion near the surfaces, coarse motion away from them. The distance is taken from
+// the origin of the object, or along the view of a camera
+double SpaceNavControl::computeGain(afBaseObjectPtr a_object)
+{
+    if (!a_object || !m_params->m_useGainScheduling){
+        return 1.0;
+    }
+
+    const SpaceNavFrames& frames = m_frames;
+    btVector3 pos(frames.m_globalPos.x(), frames.m_globalPos.y(), frames.m_globalPos.z());
+    double distance;
+    if (a_object->getType() == afType::CAMERA){
+        // The cameras look along their x axis
+        cVector3d view = frames.m_globalRot.getCol0();
+        distance = m_proximity.getRayDistance(a_object, pos, btVector3(view.x(), view.y(), view.z()),
+                                              m_params->m_gainFarDistance, m_params->m_gainTolerance);
+    }
+    else{
+        const btCollisionObject* ignore = nullptr;
+        if (a_object->getType() == afType::RIGID_BODY){
+            ignore = afRigidBodyPtr(a_object)->m_bulletRigidBody;
+        }
+        distance = m_proximity.getDistance(a_object, pos, m_params->m_gainFarDistance, m_params->m_gainTolerance, ignore);
+    }
+
+    double ratio = (distance - m_params->m_gainNearDistance) / (m_params->m_gainFarDistance - m_params->m_gainNearDistance);
+    return m_params->m_gainMin + (1.0 - m_params->m_gainMin) * cClamp(ratio, 0.0, 1.0);
+}
+
+void SpaceNavControl::computeFrames(afBaseObjectPtr a_object, SpaceNavFrames& a_frames)
+{
+    a_frames.m_object = a_object;
+    cVector3d cameraPos;
+    getLocalPose(m_camera, cameraPos, a_frames.m_cameraRot);
+    a_frames.m_legacyRotation = false;
+    if (!a_object){
+        return;
+    }
+
+    getLocalPose(a_object, a_frames.m_localPos, a_frames.m_localRot);
+    getGlobalPose(a_object, a_frames.m_globalPos, a_frames.m_globalRot);
+
+    // Rotation of the parent in the world
+    cMatrix3d localRotInv;
+    a_frames.m_localRot.transr(localRotInv);
+    cMatrix3d parentRot = a_frames.m_globalRot * localRotInv;
+
+    SpaceNavControlFrame frame = m_params->m_frame;
+    if (frame == SpaceNavControlFrame::DEFAULT){
+        frame = a_object->getType() == afType::CAMERA ? SpaceNavControlFrame::LOCAL : SpaceNavControlFrame::CAMERA;
+        a_frames.m_legacyRotation = frame == SpaceNavControlFrame::CAMERA;
+    }
+
+    switch (frame){
+    case SpaceNavControlFrame::WORLD:
+        a_frames.m_frameRotWorld.identity();
+        break;
+    case SpaceNavControlFrame::LOCAL:
+        a_frames.m_frameRotWorld = a_frames.m_globalRot;
+        break;
+    case SpaceNavControlFrame::PARENT:
+        a_frames.m_frameRotWorld = parentRot;
+        break;
+    case SpaceNavControlFrame::BODY:
+        if (m_referenceBody){
+            a_frames.m_frameRotWorld = m_referenceBody->getGlobalTransform().getLocalRot();
+        }
+        else{
+            a_frames.m_frameRotWorld.identity();
+        }
+        break;
+    default:
+        a_frames.m_frameRotWorld = a_frames.m_cameraRot;
+        break;
+    }
+
+    if (a_frames.m_legacyRotation){
+        // The default frame of the objects keeps the mapping used so far
+        a_frames.m_frameRot = a_frames.m_cameraRot;
+    }
+    else{
+        cMatrix3d parentRotInv;
+        parentRot.transr(parentRotInv);
+        a_frames.m_frameRot = parentRotInv * a_frames.m_frameRotWorld;
+    }
+}
+
+// The frames of the active object are shared by every control call of the tick
+const SpaceNavFrames& SpaceNavControl::getFrames(afBaseObjectPtr a_object)
+{
+    if (a_object == m_frames.m_object){
+        return m_frames;
+    }
+    // e.g. the other cameras of a stereo pair
+    computeFrames(a_object, m_otherFrames);
+    return m_otherFrames;
+}
+
+// Express a rotation given in the control frame in the parent frame of the object
+cMatrix3d SpaceNavControl::mapRotation(const SpaceNavFrames& a_frames, const cMatrix3d& a_rotation)
+{
+    cMatrix3d frameRotInv;
+    a_frames.m_frameRot.transr(frameRotInv);
+    if (a_frames.m_legacyRotation){
+        return frameRotInv * a_rotation * a_frames.m_frameRot;
+    }
+    return a_frames.m_frameRot * a_rotation * frameRotInv;
+}
+
+// Move the object with the translation and the given rotation in the control frame
+void SpaceNavControl::applyPose(afBaseObjectPtr a_object, const cMatrix3d& a_rotation)
+{
+    const SpaceNavFrames& frames = getFrames(a_object);
+    cMatrix3d rotation = a_rotation;
+    if (m_gain < 1.0){
+        cVector3d axis;
+        double angle;
+        if (a_rotation.toAxisAngle(axis, angle)){
+            rotation.setAxisAngleRotationRad(axis, angle * m_gain);
+        }
+    }
+    cMatrix3d deltaRot = mapRotation(frames, rotation);
+    cVector3d pos = frames.m_localPos + frames.m_frameRot * m_trans * m_gain;
+
+    // Keep the pivot in place while rotating
+    if (m_params->m_usePivot){
+        cVector3d pivot = frames.m_localPos + frames.m_localRot * cVector3d(m_params->m_pivot[0], m_params->m_pivot[1], m_params->m_pivot[2]);
+        pos += pivot + deltaRot * (frames.m_localPos - pivot) - frames.m_localPos;
+    }
+
+    // Stop at the first contact along the motion
+    if (m_params->m_useSweep){
+        cMatrix3d localRotInv;
+        frames.m_localRot.transr(localRotInv);
+        cVector3d motion = frames.m_globalRot * localRotInv * (pos - frames.m_localPos);
+        cVector3d target = frames.m_globalPos + motion;
+        double fraction = m_sweeper.sweepSphere(btVector3(frames.m_globalPos.x(), frames.m_globalPos.y(), frames.m_globalPos.z()),
+                                                btVector3(target.x(), target.y(), target.z()),
+                                                m_params->m_sweepRadius, m_params->m_sweepMargin);
+        pos = frames.m_localPos + (pos - frames.m_localPos) * fraction;
+    }
+
+    setLocalPose(a_object, pos, deltaRot * frames.m_localRot);
+}
+
+void SpaceNavControl::detachPose(afBaseObjectPtr a_object, const cVector3d& a_pos, const cMatrix3d& a_rot)
+{
+    SpaceNavPose& pose = m_detachedPoses[a_object];
+    pose.m_pos = a_pos;
+    pose.m_rot = a_rot;
+}
+
+void SpaceNavControl::getLocalPose(afBaseObjectPtr a_object, cVector3d& a_pos, cMatrix3d& a_rot)
+{
+    map<afBaseObjectPtr, SpaceNavPose>::iterator it = m_detachedPoses.find(a_object);
+    if (it != m_detachedPoses.end()){
+        a_pos = it->second.m_pos;
+        a_rot = it->second.m_rot;
+    }
+    else{
+        a_pos = a_object->getLocalPos();
+        a_rot = a_object->getLocalRot();
+    }
+}
+
+void SpaceNavControl::setLocalPose(afBaseObjectPtr a_object, const cVector3d& a_pos, const cMatrix3d& a_rot)
+{
+    map<afBaseObjectPtr, SpaceNavPose>::iterator it = m_detachedPoses.find(a_object);
+    if (it != m_detachedPoses.end()){
+        it->second.m_pos = a_pos;
+        it->second.m_rot = a_rot;
+    }
+    else{
+        a_object->setLocalPos(a_pos);
+        a_object->setLocalRot(a_rot);
+    }
+}
+
+// The global pose of a detached object is composed from its detached local pose
+void SpaceNavControl::getGlobalPose(afBaseObjectPtr a_object, cVector3d& a_pos, cMatrix3d& a_rot)
+{
+    if (!isDetached(a_object)){
+        cTransform transform = a_object->getGlobalTransform();
+        a_pos = transform.getLocalPos();
+        a_rot = transform.getLocalRot();
+        return;
+    }
+
+    getLocalPose(a_object, a_pos, a_rot);
+    afBaseObjectPtr parent = a_object->getParentObject();
+    if (parent){
+        cVector3d parentPos;
+        cMatrix3d parentRot;
+        getGlobalPose(parent, parentPos, parentRot);
+        a_pos = parentPos + parentRot * a_pos;
+        a_rot = parentRot * a_rot;
+    }
 }
 
 // Control Camera
 void SpaceNavControl::controlCamera(afCameraPtr cameraPtr)
 {   
-    int result = measured_jp();
+    SPACENAV_TRACE_SCOPE("SpaceNavControl::controlCamera");
     cMatrix3d rotation;
-    if (result == 1){ 
-        cameraPtr->setLocalPos(cameraPtr->getLocalPos() + cameraPtr->getLocalRot() * m_trans);
+    if (m_measuredResult == 1){ 
         rotation.setExtrinsicEulerRotationDeg(m_rot.x(), m_rot.y(), m_rot.z(), C_EULER_ORDER_ZYX);
-        cameraPtr->setLocalRot(cameraPtr->getLocalRot() * rotation);
+        applyPose(cameraPtr, rotation);
     }
 }
 
 // Control Object
 void SpaceNavControl::controlObject(afBaseObjectPtr objectPtr){
-    int result = measured_jp();
+    SPACENAV_TRACE_SCOPE("SpaceNavControl::controlObject");
     cMatrix3d rotation;
-    if (objectPtr && result == 1){
-        objectPtr->setLocalPos(objectPtr->getLocalPos() + m_camera->getLocalRot() * m_trans);
-        
-        rotation.setExtrinsicEulerRotationDeg(-m_scale_angular * m_rot.x(), -m_scale_angular * m_rot.y(), m_scale_angular * m_rot.z(), C_EULER_ORDER_XYZ);
-        cMatrix3d cam_rot = m_camera->getLocalRot();
-        cam_rot.invert();
-        cMatrix3d rotation1 = cam_rot * rotation * m_camera->getLocalRot();
-        objectPtr->setLocalRot(rotation1 * objectPtr->getLocalRot());
+    if (objectPtr && m_measuredResult == 1){
+        rotation.setExtrinsicEulerRotationDeg(-m_params->m_scaleAngular * m_rot.x(), -m_params->m_scaleAngular * m_rot.y(), m_params->m_scaleAngular * m_rot.z(), C_EULER_ORDER_XYZ);
+        applyPose(objectPtr, rotation);
     }
 
 }
 
 // Control RigidBody Object
 void SpaceNavControl::controlRigidBody(afRigidBodyPtr rigidBodyPtr){
-    int result = measured_jp();
-    cMatrix3d rotation;
-    if (rigidBodyPtr && result == 1){
-        btVector3 trans;
-        trans.setValue((m_camera->getLocalRot() * m_trans).x() * m_scale_linear,\
-         (m_camera->getLocalRot() * m_trans).y() * m_scale_linear,\
-          (m_camera->getLocalRot() * m_trans).z()* m_scale_linear);
-
-        btVector3 rot;
-        rot.setValue(-m_rot.x(), -m_rot.y(), m_rot.z());
+    SPACENAV_TRACE_SCOPE("SpaceNavControl::controlRigidBody");
+    if (rigidBodyPtr && m_measuredResult == 1){
+        const SpaceNavFrames& frames = getFrames(rigidBodyPtr);
+        // Velocity and force follow the latest twist of the device
+        cVector3d linear = frames.m_frameRotWorld * m_velTrans * m_params->m_scaleLinear * m_gain;
+
+        // The default frame applies the rotation in the world
+        cVector3d angular = cVector3d(-m_velRot.x(), -m_velRot.y(), m_velRot.z()) * m_gain;
+        if (!frames.m_legacyRotation){
+            angular = frames.m_frameRotWorld * angular;
+        }
 
         // Set either Force or Velocity to control the rigidbody
-        if (rigidBodyPtr->m_controller.m_positionOutputType == afControlType::FORCE){
-            rigidBodyPtr->m_bulletRigidBody->applyCentralForce(trans);
-            rigidBodyPtr->m_bulletRigidBody->applyTorque(rot);
+        SpaceNavControlMode mode = m_params->m_mode;
+        if (mode == SpaceNavControlMode::AUTO){
+            if (rigidBodyPtr->m_controller.m_positionOutputType == afControlType::FORCE){
+                mode = SpaceNavControlMode::FORCE;
+            }
+            else if (rigidBodyPtr->m_controller.m_positionOutputType == afControlType::VELOCITY){
+                mode = SpaceNavControlMode::VELOCITY;
+            }
         }
 
-        else if (rigidBodyPtr->m_controller.m_positionOutputType == afControlType::VELOCITY){
-            rigidBodyPtr->m_bulletRigidBody->setLinearVelocity(trans);
-            rigidBodyPtr->m_bulletRigidBody->setAngularVelocity(rot);
+        if (mode == SpaceNavControlMode::FORCE){
+            rigidBodyPtr->m_bulletRigidBody->applyCentralForce(btVector3(linear.x(), linear.y(), linear.z()));
+            rigidBodyPtr->m_bulletRigidBody->applyTorque(btVector3(angular.x(), angular.y(), angular.z()));
+        }
+
+        else if (mode == SpaceNavControlMode::VELOCITY){
+            // Velocity of the origin of the body when it rotates about the pivot
+            if (m_params->m_usePivot){
+                cVector3d pivot = frames.m_globalRot * cVector3d(m_params->m_pivot[0], m_params->m_pivot[1], m_params->m_pivot[2]);
+                linear += cCross(angular, -pivot);
+            }
+            rigidBodyPtr->m_bulletRigidBody->setLinearVelocity(btVector3(linear.x(), linear.y(), linear.z()));
+            rigidBodyPtr->m_bulletRigidBody->setAngularVelocity(btVector3(angular.x(), angular.y(), angular.z()));
         }
     }
 }
 
 // Control Object
 void SpaceNavControl::controlCObject(cShapeSphere* objectPtr){
-    int result = measured_jp();
+    SPACENAV_TRACE_SCOPE("SpaceNavControl::controlCObject");
     cMatrix3d rotation;
     if (objectPtr){
-        objectPtr->setLocalPos(objectPtr->getLocalPos() + m_camera->getLocalRot() * m_trans);
+        const cMatrix3d& cam_rot = m_frames.m_cameraRot;
+        objectPtr->setLocalPos(objectPtr->getLocalPos() + cam_rot * m_trans);
         rotation.setExtrinsicEulerRotationDeg(-m_rot.x(), -m_rot.y(), m_rot.z(), C_EULER_ORDER_XYZ);
-        cMatrix3d cam_rot = m_camera->getLocalRot();
-        cam_rot.invert();
-        cMatrix3d rotation1 = cam_rot * rotation * m_camera->getLocalRot();
+        cMatrix3d cam_rot_inv;
+        cam_rot.transr(cam_rot_inv);
+        cMatrix3d rotation1 = cam_rot_inv * rotation * cam_rot;
         objectPtr->setLocalRot(rotation1 * objectPtr->getLocalRot());
     }
 
@@ -213,7 +808,6 @@ void SpaceNavControl::controlCObject(cShapeSphere* objectPtr){
 
 // Get the maximum index and the value
 void SpaceNavControl::getMaxTransValue(int &axisIndex, double &value){
-    int result = measured_jp();
     double maxValue = 0;
     axisIndex = 0;
     for (int index = 0; index < 3; index++){
@@ -225,6 +819,52 @@ void SpaceNavControl::getMaxTransValue(int &axisIndex, double &value){
     value = m_trans.get(axisIndex);
 }
 
+// Get the motion that controlObject would apply, expressed in the local frame of the object
+void SpaceNavControl::getLocalDelta(afBaseObjectPtr objectPtr, cVector3d &deltaPos, cMatrix3d &deltaRot){
+    deltaPos.set(0.0, 0.0, 0.0);
+    deltaRot.identity();
+    if (!objectPtr){
+        return;
+    }
+
+    const SpaceNavFrames& frames = getFrames(objectPtr);
+    cMatrix3d rotation;
+    rotation.setExtrinsicEulerRotationDeg(-m_params->m_scaleAngular * m_rot.x(), -m_params->m_scaleAngular * m_rot.y(), m_params->m_scaleAngular * m_rot.z(), C_EULER_ORDER_XYZ);
+
+    cMatrix3d obj_rot_inv;
+    frames.m_localRot.transr(obj_rot_inv);
+    deltaPos = obj_rot_inv * (frames.m_frameRot * m_trans);
+    deltaRot = obj_rot_inv * mapRotation(frames, rotation) * frames.m_localRot;
+}
+
+// Get the filtered 6-DOF twist and the state of the buttons (1: pressed)
+void SpaceNavControl::getDeviceState(double* twist, int* buttons){
+    for (int i = 0; i < 3; i++){
+        twist[i] = m_velTrans.get(i);
+        twist[3 + i] = m_velRot.get(i);
+    }
+    for (int i = 0; i < 2; i++){
+        buttons[i] = (m_buttonMask >> i) & 1u;
+    }
+}
+
 void SpaceNavControl::close(){
+    stopControlThread();
+    if (m_calibrator.isEnabled() && !m_calibrationFilepath.empty()){
+        m_calibrator.save(m_calibrationFilepath, m_calibrationDevice);
+    }
+    if (m_sweeper.getClampCount() > 0){
+        cerr << "INFO! Collision sweep: the motion was stopped " << m_sweeper.getClampCount() << " times" << endl;
+    }
+    if (m_proximity.getQueryCount() > 0){
+        cerr << "INFO! Gain scheduling: " << m_proximity.getQueryCount() << " distance queries" << endl;
+    }
+    if (m_networkInput.isOpen()){
+        NetworkInputStats stats = m_networkInput.getStats();
+        cerr << "INFO! Network input: " << stats.m_received << " packets, " << stats.m_lost << " lost, " << stats.m_late
+             << " late, " << stats.m_overflows << " overflows, " << stats.m_timeouts << " timeouts, jitter "
+             << stats.m_jitter * 1e6 << " us, held " << stats.m_meanHold * 1e6 << " us" << endl;
+        m_networkInput.close();
+    }
     spnav_close();
 }
\ No newline at end of file
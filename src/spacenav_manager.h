@@ -43,17 +43,71 @@
 #ifndef SPACENAV_MANAGER_H
 #define SPACENAV_MANAGER_H
 
-#include "ros/ros.h"
 #include <afFramework.h>
 
-#include <sensor_msgs/Joy.h>
 #include <spnav.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "adaptive_deadband.h"
+#include "button_actions.h"
+#include "device_calibrator.h"
+#include "metrics.h"
+#include "motion_sweeper.h"
+#include "network_input.h"
+#include "proximity_cache.h"
+#include "spacenav_config.h"
+#include "spacenav_input.h"
+#include "spsc_queue.h"
+#include "tracer.h"
+#include "triple_buffer.h"
 
 using namespace chai3d;
 using namespace ambf;
 using namespace std;
 
 
+// Transforms used to map the motion of the device onto an object
+struct SpaceNavFrames{
+    afBaseObjectPtr m_object = nullptr;
+    cVector3d m_localPos;
+    cMatrix3d m_localRot; // Object in its parent frame
+    cVector3d m_globalPos;
+    cMatrix3d m_globalRot; // Object in the world
+    cMatrix3d m_cameraRot; // Viewing camera
+    cMatrix3d m_frameRot; // Control frame in the parent frame of the object
+    cMatrix3d m_frameRotWorld; // Control frame in the world
+    bool m_legacyRotation = false; // Default frame of the non camera objects
+};
+
+// Pose of an object in its parent frame
+struct SpaceNavPose{
+    cVector3d m_pos;
+    cMatrix3d m_rot;
+};
+
+// State of the device handed over from the control thread to the physics thread
+struct SpaceNavDeviceState{
+    int m_result = -1;
+    double m_time = 0.0;
+    double m_twist[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0}; // Latest twist [x, y, z, rx, ry, rz]
+    double m_integrated[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0}; // Sum of the twist in nominal physics steps
+    unsigned int m_buttonMask = 0; // Bit i is set while button i is pressed
+};
+
+// Idle detection of one input source. The source is static after the idle time without a change
+struct SpaceNavIdleState{
+    double m_lastEventTime = 0.0;
+    bool m_idleApplied = true;
+};
+
+struct SpaceNavLoopStats{
+    unsigned long m_count = 0;
+    unsigned long m_overruns = 0; // Missed periods
+    double m_meanJitter = 0.0; // Mean lateness of the wake ups [s]
+    double m_maxJitter = 0.0; // [s]
+};
+
 class SpaceNavControl{
 
     public:
@@ -66,6 +120,53 @@ class SpaceNavControl{
         void controlRigidBody(afRigidBodyPtr rigidBodyPtr);
         void controlCObject(cShapeSphere* objectPtr);
         void getMaxTransValue(int &axisIndex, double &value);
+        void getLocalDelta(afBaseObjectPtr objectPtr, cVector3d &deltaPos, cMatrix3d &deltaRot);
+        void getDeviceState(double* twist, int* buttons);
+        unsigned int getButtonMask(){ return m_buttonMask; }
+
+        // Button edges in the order they were received. Call from the physics thread
+        bool popButtonEvent(SpaceNavButtonEvent& a_event){ return m_buttonEvents.pop(a_event); }
+        // Time base of the button events [s]
+        double getTime();
+
+        // Parameters of the active object. The pointer has to stay valid while it is active
+        void setParams(const SpaceNavControlParams* a_params);
+
+        // The pose of a detached object is written by another thread (e.g. a camera rendered through a
+        // pose filter). The control reads and moves this copy of it instead of the object.
+        // Call from the physics thread, or before it starts
+        void detachPose(afBaseObjectPtr a_object, const cVector3d& a_pos, const cMatrix3d& a_rot);
+        bool isDetached(afBaseObjectPtr a_object){ return m_detachedPoses.count(a_object) > 0; }
+
+        // Pose of the objects as seen by the control, detached or not. Call from the physics thread
+        void getLocalPose(afBaseObjectPtr a_object, cVector3d& a_pos, cMatrix3d& a_rot);
+        void setLocalPose(afBaseObjectPtr a_object, const cVector3d& a_pos, const cMatrix3d& a_rot);
+        void getGlobalPose(afBaseObjectPtr a_object, cVector3d& a_pos, cMatrix3d& a_rot);
+
+        // Computes the frames of the active object. Call once per tick after setParams
+        void updateFrames(afBaseObjectPtr a_object, afBaseObjectPtr a_referenceBody = nullptr);
+
+        // External input (e.g. from a ROS topic)
+        bool setInputSource(SpaceNavInputSource a_source, int a_queueSize);
+        bool pushInput(const SpaceNavInputSample& a_sample);
+        bool isInputEnabled(){ return m_spanavEnable || m_inputSource != SpaceNavInputSource::DEVICE; }
+        SpaceNavInputSource getInputSource(){ return m_inputSource; }
+
+        // Take the raw counts of a remote device instead of the local one. Call before the control thread is started
+        bool initNetworkInput(const NetworkInputParams& a_params);
+
+        // Clamping and range calibration of the device. Call before the control thread is started.
+        // The calibration is stored in a_filepath under a_device at close
+        void setSaturation(double a_saturation){ m_calibrator.setSaturation(a_saturation); }
+        void setAdaptiveDeadband(const AdaptiveDeadbandParams& a_params){ m_adaptiveDeadband.init(a_params); }
+        void initCalibration(const string& a_filepath, const string& a_device, double a_nominalRange,
+                             double a_restThreshold, double a_restTime, double a_learningRate);
+
+        // Poll and filter the input on a thread at a fixed rate instead of in measured_jp.
+        // a_nominalRate: physics rate at which the motion has the configured speed
+        bool startControlThread(double a_rate, double a_nominalRate, int a_priority = 0);
+        void stopControlThread();
+        SpaceNavLoopStats getLoopStats();
         void close();
 
     // private:
@@ -77,22 +178,106 @@ class SpaceNavControl{
         afRigidBodyPtr m_rigidBody;
 
         // Spacenav related param
-        vector<double> m_scale; 
-        vector<double> m_deadbound; // if the value is less than this value, then we regard them as "static"
-        int m_staticCountThres;
-        int m_noMotion = 0;
+        SpaceNavControlParams m_defaultParams;
+        const SpaceNavControlParams* m_params;
+        double m_idleTime = 0.1; // [s] without events before the device is considered "static"
 
+        // Motion to apply in the current physics step
         cVector3d m_trans;
         cVector3d m_rot;
 
-        vector<double> m_buttons;
+        // Latest twist of the device, used for the velocity and the force control
+        cVector3d m_velTrans;
+        cVector3d m_velRot;
+
+        unsigned int m_buttonMask = 0;
+        int m_measuredResult = -1;
         bool m_spanavEnable = false;
+
+        // Device side. Owned by the control thread while it runs
+        const SpaceNavControlParams* m_deviceParams;
+        atomic<const SpaceNavControlParams*> m_sharedParams;
         spnav_event sev;
+        // Separate for the device and the external input, so that in MERGED mode the idle
+        // deadband of one source does not zero the motion the other one is driving
+        SpaceNavIdleState m_deviceIdle;
+        SpaceNavIdleState m_inputIdle;
+        const SpaceNavIdleState* m_motionSource = &m_deviceIdle; // Source of the current motion
+        AdaptiveDeadband m_adaptiveDeadband;
+        double m_raw[6]; // Last raw device counts [x, y, z, rx, ry, rz]
+        double m_deviceTwist[6]; // After the scaling of the active object
+        unsigned int m_deviceButtonMask = 0;
+        SpscQueue<SpaceNavButtonEvent> m_buttonEvents{64};
+        chrono::steady_clock::time_point m_startTime;
+        DeviceCalibrator m_calibrator;
+        string m_calibrationFilepath;
+        string m_calibrationDevice;
 
         int count = 0;
 
-        double m_scale_linear;
-        double m_scale_angular;
+        // Poses of the detached objects. Only the values change after init
+        map<afBaseObjectPtr, SpaceNavPose> m_detachedPoses;
+
+        // Frames of the active object for the current tick
+        SpaceNavFrames m_frames;
+        SpaceNavFrames m_otherFrames;
+        afBaseObjectPtr m_referenceBody = nullptr;
+
+        // Collision check of the motion of the objects moved by pose
+        MotionSweeper m_sweeper;
+
+        // Gain of the motion of the active object from its distance to the surfaces
+        ProximityCache m_proximity;
+        double m_gain = 1.0;
+
+        // External input
+        SpaceNavInputSource m_inputSource = SpaceNavInputSource::DEVICE;
+        SpscQueue<SpaceNavInputSample> m_inputQueue;
+        unsigned int m_inputButtons = 0;
+        atomic<unsigned long> m_inputDropped{0};
+        NetworkInputReceiver m_networkInput;
+        double m_inputAxes[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0}; // Last external counts, to detect the changes
+
+        // Control thread
+        thread m_controlThread;
+        atomic<bool> m_controlRunning{false};
+        TripleBuffer<SpaceNavDeviceState> m_deviceState;
+        double m_lastIntegrated[6];
+        double m_controlPeriod = 0.001;
+        double m_nominalRate = 1000.0;
+        int m_controlPriority = 0;
+        atomic<unsigned long> m_loopCount{0};
+        atomic<unsigned long> m_loopOverruns{0};
+        atomic<double> m_loopJitterSum{0.0};
+        atomic<double> m_loopMaxJitter{0.0};
+
+        // Runtime counters, owned by the metrics registry
+        MetricCounter* m_motionEventCount;
+        MetricCounter* m_buttonEventCount;
+        MetricCounter* m_inputSampleCount;
+        MetricCounter* m_saturatedEventCount;
+        MetricCounter* m_deadbandTransCount;
+        MetricCounter* m_deadbandRotCount;
+        MetricCounter* m_idlePollCount;
+
+    protected:
+        int pollInputs();
+        int pollDevice();
+        void pollInputQueue();
+        void pollNetworkInput();
+        void filterInputSample(SpaceNavInputSample& a_sample, double a_time);
+        void applyIdleDeadband(SpaceNavIdleState& a_state, double a_time);
+        void applyInputSample(const SpaceNavInputSample& a_sample);
+        void applyMotion(const double* raw);
+        void applyButton(int bnum, bool pressed);
+        void computeTwist();
+        void controlLoop();
+        int readDeviceState();
+        void computeFrames(afBaseObjectPtr a_object, SpaceNavFrames& a_frames);
+        double computeGain(afBaseObjectPtr a_object);
+        const SpaceNavFrames& getFrames(afBaseObjectPtr a_object);
+        cMatrix3d mapRotation(const SpaceNavFrames& a_frames, const cMatrix3d& a_rotation);
+        void applyPose(afBaseObjectPtr a_object, const cMatrix3d& a_rotation);
         
 
 
@@ -0,0 +1,181 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+#ifndef SPACENAV_STATE_H
+#define SPACENAV_STATE_H
+
+// This header has no dependency other than the standard library so that external
+// tools can include it to read the state exported by the plugin.
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+#define SPACENAV_STATE_MAGIC 0x53564e53 // "SNVS"
+#define SPACENAV_STATE_VERSION 1
+#define SPACENAV_STATE_NAME_SIZE 64
+
+// State of the plugin after one physics step
+struct SpaceNavStateSample{
+    double m_time = 0.0; // Time since the plugin started [s]
+    double m_twist[6] = {0, 0, 0, 0, 0, 0}; // Filtered device motion [x, y, z, rx, ry, rz]
+    uint32_t m_buttons = 0; // Bit i is set while button i is pressed
+    int32_t m_activeIndex = -1; // Index of the active controllable object
+    char m_activeName[SPACENAV_STATE_NAME_SIZE] = {0};
+
+    // Slicing
+    uint8_t m_isSlicing = 0;
+    uint8_t m_isPublishing = 0;
+    uint8_t m_sliceMode = 0; // 0: symmetric, 1: box, 2: plane
+    uint8_t m_clipPlaneEnabled = 0;
+    double m_sliceMinCorner[3] = {0, 0, 0};
+    double m_sliceMaxCorner[3] = {0, 0, 0};
+    double m_clipPlaneNormal[3] = {0, 0, 1};
+    double m_clipPlaneOffset = 0.0;
+};
+
+struct SeqlockRingHeader{
+    uint32_t m_magic;
+    uint32_t m_version;
+    uint32_t m_slotCount;
+    uint32_t m_slotSize;
+    std::atomic<uint64_t> m_writeIndex; // Number of samples written so far
+};
+
+template <typename T>
+struct SeqlockSlot{
+    std::atomic<uint64_t> m_seq; // Odd while the slot is being written
+    T m_data;
+};
+
+// Ring of samples with one writer and any number of readers, laid out in a caller provided
+// block of memory (e.g. POSIX shared memory). The writer never waits. A reader copies the
+// slot and retries if the writer touched it during the copy. T has to be trivially copyable.
+template <typename T>
+class SeqlockRing{
+    public:
+        static size_t getRequiredSize(uint32_t a_slotCount){
+            return sizeof(SeqlockRingHeader) + size_t(a_slotCount) * sizeof(SeqlockSlot<T>);
+        }
+
+        // Writer side. Formats the memory
+        bool create(void* a_memory, uint32_t a_slotCount){
+            if (!a_memory || a_slotCount == 0){
+                return false;
+            }
+            m_header = static_cast<SeqlockRingHeader*>(a_memory);
+            m_slots = reinterpret_cast<SeqlockSlot<T>*>(m_header + 1);
+            m_header->m_slotCount = a_slotCount;
+            m_header->m_slotSize = sizeof(SeqlockSlot<T>);
+            m_header->m_writeIndex.store(0, std::memory_order_relaxed);
+            for (uint32_t i = 0; i < a_slotCount; i++){
+                m_slots[i].m_seq.store(0, std::memory_order_relaxed);
+            }
+            m_header->m_version = SPACENAV_STATE_VERSION;
+            std::atomic_thread_fence(std::memory_order_release);
+            m_header->m_magic = SPACENAV_STATE_MAGIC;
+            return true;
+        }
+
+        // Reader side. Attaches to memory formatted by create
+        bool attach(void* a_memory){
+            SeqlockRingHeader* header = static_cast<SeqlockRingHeader*>(a_memory);
+            if (!header || header->m_magic != SPACENAV_STATE_MAGIC || header->m_version != SPACENAV_STATE_VERSION ||
+                    header->m_slotSize != sizeof(SeqlockSlot<T>)){
+                return false;
+            }
+            m_header = header;
+            m_slots = reinterpret_cast<SeqlockSlot<T>*>(m_header + 1);
+            return true;
+        }
+
+        void write(const T& a_data){
+            uint64_t index = m_header->m_writeIndex.load(std::memory_order_relaxed);
+            SeqlockSlot<T>& slot = m_slots[index % m_header->m_slotCount];
+            slot.m_seq.store(2 * index + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            memcpy(&slot.m_data, &a_data, sizeof(T));
+            slot.m_seq.store(2 * index + 2, std::memory_order_release);
+            m_header->m_writeIndex.store(index + 1, std::memory_order_release);
+        }
+
+        // Reads the sample number a_index. Returns false if it is not written yet or was overwritten
+        bool read(uint64_t a_index, T& a_data) const{
+            const SeqlockSlot<T>& slot = m_slots[a_index % m_header->m_slotCount];
+            uint64_t seq = slot.m_seq.load(std::memory_order_acquire);
+            if (seq != 2 * a_index + 2){
+                return false;
+            }
+            memcpy(&a_data, &slot.m_data, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return slot.m_seq.load(std::memory_order_relaxed) == seq;
+        }
+
+        bool readLatest(T& a_data, uint64_t* a_index = nullptr) const{
+            for (int attempt = 0; attempt < 16; attempt++){
+                uint64_t count = getWriteIndex();
+                if (count == 0){
+                    return false;
+                }
+                if (read(count - 1, a_data)){
+                    if (a_index){
+                        *a_index = count - 1;
+                    }
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        uint64_t getWriteIndex() const{
+            return m_header->m_writeIndex.load(std::memory_order_acquire);
+        }
+
+        bool isValid() const{
+            return m_header != nullptr;
+        }
+
+    private:
+        SeqlockRingHeader* m_header = nullptr;
+        SeqlockSlot<T>* m_slots = nullptr;
+};
+
+#endif //SPACENAV_STATE_H
@@ -0,0 +1,161 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+
+// Streams the local spacenav to the network input of the plugin on another machine:
+//   spacenav_udp_sender --host <simulator> --port 5700 --rate 250
+// --synthetic sends a slow sine on the x axis instead, to test the link without a device.
+
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <poll.h>
+#include <signal.h>
+#include <spnav.h>
+#include "network_input.h"
+
+namespace p_opt = boost::program_options;
+using namespace std;
+
+static volatile sig_atomic_t s_running = 1;
+
+static void handleSignal(int)
+{
+    s_running = 0;
+}
+
+int main(int argc, char** argv)
+{
+    p_opt::options_description cmd_opts("SpaceNav UDP sender Command Line Options");
+    cmd_opts.add_options()
+            ("help", "Show Info")
+            ("host", p_opt::value<string>()->default_value("127.0.0.1"), "Address of the simulator")
+            ("port", p_opt::value<int>()->default_value(SPACENAV_DEFAULT_PORT), "Port of the network input")
+            ("rate", p_opt::value<double>()->default_value(250.0), "Rate of the packets sent while nothing changes [Hz]")
+            ("synthetic", "Send a sine on the x axis instead of the device");
+
+    p_opt::variables_map var_map;
+    try{
+        p_opt::store(p_opt::parse_command_line(argc, argv, cmd_opts), var_map);
+        p_opt::notify(var_map);
+    }
+    catch (const exception& e){
+        cerr << "[ERROR] " << e.what() << endl;
+        return 1;
+    }
+    if (var_map.count("help")){
+        cout << cmd_opts << endl;
+        return 0;
+    }
+
+    double rate = var_map["rate"].as<double>();
+    if (rate <= 0.0){
+        cerr << "[ERROR] The rate has to be positive." << endl;
+        return 1;
+    }
+    bool synthetic = var_map.count("synthetic") > 0;
+    if (!synthetic && spnav_open() == -1){
+        cerr << "ERROR! Could not open the space navigator device." << endl;
+        return 1;
+    }
+
+    NetworkInputSender sender;
+    string host = var_map["host"].as<string>();
+    int port = var_map["port"].as<int>();
+    if (!sender.open(host, port)){
+        return 1;
+    }
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+    cerr << "INFO! Sending the " << (synthetic ? "synthetic motion" : "spacenav") << " to " << host << ":" << port << endl;
+
+    SpaceNavInputSample sample;
+    sample.m_hasMotion = true;
+    sample.m_hasButtons = true;
+    pollfd descriptor;
+    descriptor.fd = synthetic ? -1 : spnav_fd();
+    descriptor.events = POLLIN;
+    int timeout = max(1, int(1000.0 / rate));
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    unsigned long failed = 0;
+
+    while (s_running){
+        // Send as soon as the device has events, and at the rate otherwise so that the
+        // receiver sees the link alive
+        if (synthetic){
+            poll(nullptr, 0, timeout);
+            double time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            sample.m_axes[0] = 200.0 * sin(2.0 * M_PI * 0.25 * time);
+        }
+        else if (poll(&descriptor, 1, timeout) > 0){
+            spnav_event sev;
+            while (spnav_poll_event(&sev) != 0){
+                if (sev.type == SPNAV_EVENT_MOTION){
+                    sample.m_axes[0] = sev.motion.x;
+                    sample.m_axes[1] = sev.motion.y;
+                    sample.m_axes[2] = sev.motion.z;
+                    sample.m_axes[3] = sev.motion.rx;
+                    sample.m_axes[4] = sev.motion.ry;
+                    sample.m_axes[5] = sev.motion.rz;
+                }
+                else if (sev.type == SPNAV_EVENT_BUTTON && sev.button.bnum >= 0 && sev.button.bnum < SPACENAV_MAX_BUTTONS){
+                    if (sev.button.press){
+                        sample.m_buttons |= 1u << sev.button.bnum;
+                    }
+                    else{
+                        sample.m_buttons &= ~(1u << sev.button.bnum);
+                    }
+                }
+            }
+        }
+        if (!sender.send(sample)){
+            failed++;
+        }
+    }
+
+    cerr << "INFO! Sent " << sender.getSentCount() << " packets, " << failed << " failed" << endl;
+    sender.close();
+    if (!synthetic){
+        spnav_close();
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <vector>
+
+using namespace std;
+
+// Largest number of items of a queue, far above any use in the plugin
+#define SPSC_QUEUE_MAX_CAPACITY (size_t(1) << 24)
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// The capacity is rounded up to a power of two. T has to be trivially copyable.
+template <typename T>
+class SpscQueue{
+    public:
+        SpscQueue(size_t a_capacity = 256){
+            init(a_capacity);
+        }
+
+        // Not thread safe. Call before the producer and the consumer start.
+        // Returns false, and keeps the queue as it was, above SPSC_QUEUE_MAX_CAPACITY
+        bool init(size_t a_capacity){
+            if (a_capacity > SPSC_QUEUE_MAX_CAPACITY){
+                return false;
+            }
+            size_t capacity = 1;
+            while (capacity < a_capacity){
+                capacity <<= 1;
+            }
+            m_buffer.assign(capacity, T());
+            m_mask = capacity - 1;
+            m_head.store(0, memory_order_relaxed);
+            m_tail.store(0, memory_order_relaxed);
+            return true;
+        }
+
+        // Producer side. Returns false if the queue is full
+        bool push(const T& a_item){
+            size_t head = m_head.load(memory_order_relaxed);
+            if (head - m_tail.load(memory_order_acquire) > m_mask){
+                return false;
+            }
+            m_buffer[head & m_mask] = a_item;
+            m_head.store(head + 1, memory_order_release);
+            return true;
+        }
+
+        // Producer side. If the queue is full the oldest item is dropped to make room.
+        // Returns true if an item was dropped
+        bool pushOverwrite(const T& a_item){
+            size_t head = m_head.load(memory_order_relaxed);
+            size_t tail = m_tail.load(memory_order_acquire);
+            bool dropped = false;
+            while (head - tail > m_mask){
+                // Compete with the consumer for the oldest item
+                if (m_tail.compare_exchange_weak(tail, tail + 1, memory_order_acq_rel)){
+                    dropped = true;
+                    break;
+                }
+            }
+            m_buffer[head & m_mask] = a_item;
+            m_head.store(head + 1, memory_order_release);
+            return dropped;
+        }
+
+        // Consumer side. Returns false if the queue is empty
+        bool pop(T& a_item){
+            size_t tail = m_tail.load(memory_order_acquire);
+            while (tail != m_head.load(memory_order_acquire)){
+                // The slot may be overwritten by pushOverwrite while it is copied. In that case
+                // the producer has already moved the tail and the copy is thrown away
+                T item = m_buffer[tail & m_mask];
+                if (m_tail.compare_exchange_weak(tail, tail + 1, memory_order_acq_rel)){
+                    a_item = item;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        size_t size() const{
+            return m_head.load(memory_order_acquire) - m_tail.load(memory_order_acquire);
+        }
+
+        size_t capacity() const{
+            return m_mask + 1;
+        }
+
+    private:
+        vector<T> m_buffer;
+        size_t m_mask = 0;
+
+        // Kept on separate cache lines so that the producer and the consumer do not share one
+        alignas(64) atomic<size_t> m_head; // Next slot written by the producer
+        alignas(64) atomic<size_t> m_tail; // Next slot read by the consumer
+};
+
+#endif //SPSC_QUEUE_H
@@ -0,0 +1,89 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+
+#include "texture_cache.h"
+
+using namespace std;
+
+TextureCache::TextureCache(){
+
+}
+
+TextureCache* TextureCache::getInstance(){
+    static TextureCache s_instance;
+    return &s_instance;
+}
+
+TextureFuture TextureCache::request(string a_filepath){
+    lock_guard<mutex> lock(m_mutex);
+
+    map<string, TextureFuture>::iterator it = m_textures.find(a_filepath);
+    if (it != m_textures.end()){
+        return it->second;
+    }
+
+    TextureFuture future = async(launch::async, &TextureCache::loadTexture, a_filepath).share();
+    m_textures[a_filepath] = future;
+    return future;
+}
+
+bool TextureCache::isReady(const TextureFuture& a_future){
+    return a_future.valid() && a_future.wait_for(chrono::seconds(0)) == future_status::ready;
+}
+
+void TextureCache::clear(){
+    lock_guard<mutex> lock(m_mutex);
+    m_textures.clear();
+}
+
+TextureLoadResult TextureCache::loadTexture(string a_filepath){
+    TextureLoadResult result;
+    cPrecisionClock clock;
+    clock.start(true);
+
+    // Only decodes the image. The texture is uploaded to the GPU when it is first rendered
+    result.m_texture = cTexture2d::create();
+    result.m_success = result.m_texture->loadFromFile(a_filepath);
+    result.m_loadTime = clock.getCurrentTimeSeconds();
+
+    return result;
+}
@@ -0,0 +1,86 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+// To silence warnings on MacOS
+#define GL_SILENCE_DEPRECATION
+#include <afFramework.h>
+
+#include <future>
+#include <map>
+#include <mutex>
+
+using namespace chai3d;
+using namespace std;
+
+struct TextureLoadResult{
+    cTexture2dPtr m_texture;
+    bool m_success = false;
+    double m_loadTime = 0.0; // Time spent decoding the file [s]
+};
+
+typedef shared_future<TextureLoadResult> TextureFuture;
+
+// Decodes textures on background threads. Textures are keyed by their file path
+// so that a file requested several times is only decoded once and shared.
+class TextureCache{
+    public:
+        static TextureCache* getInstance();
+
+        // Returns immediately. The texture is loaded in the background the first time a path is requested
+        TextureFuture request(string a_filepath);
+
+        // True if the texture has been decoded (successfully or not)
+        static bool isReady(const TextureFuture& a_future);
+
+        void clear();
+
+    private:
+        TextureCache();
+        static TextureLoadResult loadTexture(string a_filepath);
+
+        map<string, TextureFuture> m_textures;
+        mutex m_mutex;
+};
+
+#endif //TEXTURE_CACHE_H
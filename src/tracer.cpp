@@ -0,0 +1,154 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "tracer.h"
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+Tracer::Tracer(){
+    m_startTime = chrono::steady_clock::now();
+}
+
+Tracer* Tracer::getInstance(){
+    static Tracer s_instance;
+    return &s_instance;
+}
+
+void Tracer::enable(uint32_t a_capacity){
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_capacity = a_capacity > 0 ? a_capacity : 1;
+    }
+    m_enabled.store(true);
+}
+
+void Tracer::disable(){
+    m_enabled.store(false);
+}
+
+namespace{
+// Buffer of the calling thread, created by its first event
+thread_local TraceBuffer* t_buffer = nullptr;
+// Name given by setThreadName, and the one the buffer currently has
+thread_local const char* t_threadName = nullptr;
+thread_local const char* t_bufferName = nullptr;
+}
+
+TraceBuffer* Tracer::getThreadBuffer(){
+    if (!t_buffer){
+        lock_guard<mutex> lock(m_mutex);
+        unique_ptr<TraceBuffer> buffer(new TraceBuffer);
+        buffer->m_capacity = m_capacity;
+        buffer->m_memory.assign((SeqlockRing<TraceEvent>::getRequiredSize(m_capacity) + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+        buffer->m_events.create(buffer->m_memory.data(), m_capacity);
+        buffer->m_tid = int(m_buffers.size()) + 1;
+        buffer->m_threadName = t_threadName ? string(t_threadName) : "thread " + to_string(buffer->m_tid);
+        t_bufferName = t_threadName;
+        t_buffer = buffer.get();
+        m_buffers.push_back(move(buffer));
+    }
+    return t_buffer;
+}
+
+void Tracer::record(const char* a_name, int64_t a_start, int64_t a_duration, TraceEventType a_type){
+    TraceEvent event;
+    event.m_name = a_name;
+    event.m_start = a_start;
+    event.m_duration = a_duration;
+    event.m_type = a_type;
+    getThreadBuffer()->m_events.write(event);
+}
+
+void Tracer::setThreadName(const char* a_name){
+    t_threadName = a_name;
+    // Without a buffer the name is applied when the first event creates it
+    if (!isEnabled() || !t_buffer || t_bufferName == a_name){
+        return;
+    }
+    lock_guard<mutex> lock(m_mutex);
+    t_buffer->m_threadName = a_name;
+    t_bufferName = a_name;
+}
+
+bool Tracer::writeChromeTrace(const string& a_filepath){
+    ofstream file(a_filepath);
+    if (!file.is_open()){
+        cerr << "ERROR! Could not open the trace file " << a_filepath << endl;
+        return false;
+    }
+
+    lock_guard<mutex> lock(m_mutex);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    size_t numEvents = 0;
+    for (const unique_ptr<TraceBuffer>& buffer: m_buffers){
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->m_tid
+             << ",\"args\":{\"name\":\"" << buffer->m_threadName << "\"}}";
+        first = false;
+
+        // The events that are overwritten during the copy are skipped by the ring
+        uint64_t end = buffer->m_events.getWriteIndex();
+        uint64_t begin = end > buffer->m_capacity ? end - buffer->m_capacity : 0;
+        TraceEvent event;
+        for (uint64_t i = begin; i < end; i++){
+            if (!buffer->m_events.read(i, event)){
+                continue;
+            }
+            file << ",\n{\"name\":\"" << event.m_name << "\",\"pid\":1,\"tid\":" << buffer->m_tid
+                 << ",\"ts\":" << event.m_start / 1000.0;
+            if (event.m_type == TraceEventType::COMPLETE){
+                file << ",\"ph\":\"X\",\"dur\":" << event.m_duration / 1000.0 << "}";
+            }
+            else{
+                file << ",\"ph\":\"i\",\"s\":\"t\"}";
+            }
+            numEvents++;
+        }
+    }
+    file << "\n]}\n";
+
+    cerr << "INFO! Wrote " << numEvents << " trace events to " << a_filepath << endl;
+    return true;
+}
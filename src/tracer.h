@@ -0,0 +1,145 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "spacenav_state.h"
+
+using namespace std;
+
+enum class TraceEventType{
+    COMPLETE=0, // Span with a duration
+    INSTANT=1
+};
+
+struct TraceEvent{
+    const char* m_name = nullptr; // Has to be a string literal
+    int64_t m_start = 0; // [ns] since the tracer was created
+    int64_t m_duration = 0; // [ns]
+    TraceEventType m_type = TraceEventType::COMPLETE;
+};
+
+// Events of one thread. Only the owner thread writes, the flush reads without locking
+struct TraceBuffer{
+    vector<uint64_t> m_memory;
+    SeqlockRing<TraceEvent> m_events;
+    uint32_t m_capacity = 0;
+    int m_tid = 0;
+    string m_threadName;
+};
+
+// Records spans in per-thread rings and writes them as a Chrome trace (chrome://tracing, Perfetto)
+class Tracer{
+    public:
+        static Tracer* getInstance();
+
+        // a_capacity: number of events kept per thread. The oldest are overwritten
+        void enable(uint32_t a_capacity);
+        void disable();
+        bool isEnabled() const{ return m_enabled.load(memory_order_relaxed); }
+
+        int64_t now() const{
+            return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - m_startTime).count();
+        }
+
+        void record(const char* a_name, int64_t a_start, int64_t a_duration, TraceEventType a_type);
+        // Name of the calling thread in the trace, a string literal. Only kept until the first
+        // event of the thread creates its buffer, so it costs a pointer store when disabled
+        void setThreadName(const char* a_name);
+
+        // Writes the events currently in the rings. Can be called while the threads are running
+        bool writeChromeTrace(const string& a_filepath);
+
+    private:
+        Tracer();
+        TraceBuffer* getThreadBuffer();
+
+        atomic<bool> m_enabled{false};
+        uint32_t m_capacity = 65536;
+        chrono::steady_clock::time_point m_startTime;
+
+        // Buffers are only added, under the mutex, and live until the end of the process
+        mutex m_mutex;
+        vector<unique_ptr<TraceBuffer>> m_buffers;
+};
+
+// Records the time from its construction to its destruction
+class TraceScope{
+    public:
+        TraceScope(const char* a_name): m_name(a_name){
+            if (Tracer::getInstance()->isEnabled()){
+                m_start = Tracer::getInstance()->now();
+            }
+        }
+        ~TraceScope(){
+            if (m_start >= 0 && Tracer::getInstance()->isEnabled()){
+                Tracer::getInstance()->record(m_name, m_start, Tracer::getInstance()->now() - m_start, TraceEventType::COMPLETE);
+            }
+        }
+
+    private:
+        const char* m_name;
+        int64_t m_start = -1;
+};
+
+// The tracing compiles to nothing without BUILD_WITH_TRACING
+#ifdef BUILD_WITH_TRACING
+#define SPACENAV_TRACE_CONCAT_INNER(a, b) a##b
+#define SPACENAV_TRACE_CONCAT(a, b) SPACENAV_TRACE_CONCAT_INNER(a, b)
+#define SPACENAV_TRACE_SCOPE(name) TraceScope SPACENAV_TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define SPACENAV_TRACE_INSTANT(name) \
+    do { if (Tracer::getInstance()->isEnabled()) Tracer::getInstance()->record(name, Tracer::getInstance()->now(), 0, TraceEventType::INSTANT); } while (0)
+#define SPACENAV_TRACE_THREAD_NAME(name) Tracer::getInstance()->setThreadName(name)
+#else
+#define SPACENAV_TRACE_SCOPE(name) do {} while (0)
+#define SPACENAV_TRACE_INSTANT(name) do {} while (0)
+#define SPACENAV_TRACE_THREAD_NAME(name) do {} while (0)
+#endif
+
+#endif //TRACER_H
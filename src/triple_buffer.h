@@ -0,0 +1,99 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+using namespace std;
+
+// Lock-free handoff of the latest value from one writer thread to one reader thread.
+// The writer never waits and the reader always gets the newest complete value.
+template <typename T>
+class TripleBuffer{
+    public:
+        TripleBuffer(){
+            m_writeIndex = 0;
+            m_readIndex = 1;
+            m_shared.store(2, memory_order_relaxed);
+        }
+
+        // Writer side
+        T& getWriteBuffer(){
+            return m_buffers[m_writeIndex];
+        }
+
+        void publish(){
+            // Swap the written buffer with the shared one and mark it as new
+            m_writeIndex = m_shared.exchange(m_writeIndex | NEW_BIT, memory_order_acq_rel) & INDEX_MASK;
+        }
+
+        void write(const T& a_value){
+            getWriteBuffer() = a_value;
+            publish();
+        }
+
+        // Reader side. Returns true if a new value was published since the last call
+        bool update(){
+            if (!(m_shared.load(memory_order_relaxed) & NEW_BIT)){
+                return false;
+            }
+            m_readIndex = m_shared.exchange(m_readIndex, memory_order_acq_rel) & INDEX_MASK;
+            return true;
+        }
+
+        const T& getReadBuffer() const{
+            return m_buffers[m_readIndex];
+        }
+
+    private:
+        static const int INDEX_MASK = 3;
+        static const int NEW_BIT = 4;
+
+        T m_buffers[3];
+        int m_writeIndex;
+        int m_readIndex;
+        atomic<int> m_shared;
+};
+
+#endif //TRIPLE_BUFFER_H
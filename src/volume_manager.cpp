@@ -45,6 +45,8 @@
 
 
 #include "volume_manager.h"
+#include <algorithm>
+#include <fstream>
 
 using namespace std;
 using namespace ambf;
@@ -56,7 +58,9 @@ VolumeManager::VolumeManager(){
 bool VolumeManager::initVolume(const afWorldPtr a_worldPtr,  string volume_name, string volumeMatcapFilepath)
 {
     cout << "> INITIAlIZING VOLUME ..." << endl;
-    
+    cPrecisionClock initClock;
+    initClock.start(true);
+
     m_worldPtr = a_worldPtr;
 
     // Get the volume
@@ -76,25 +80,102 @@ bool VolumeManager::initVolume(const afWorldPtr a_worldPtr,  string volume_name,
         m_textureCoordScale(0) = (m_maxTexCoord.x() - m_minTexCoord.x()) / (m_maxVolCorner.x() - m_minVolCorner.x());
         m_textureCoordScale(1) = (m_maxTexCoord.y() - m_minTexCoord.y()) / (m_maxVolCorner.y() - m_minVolCorner.y());
         m_textureCoordScale(2) = (m_maxTexCoord.z() - m_minTexCoord.z()) / (m_maxVolCorner.z() - m_minVolCorner.z());
+
+        m_sliceState.m_maxCorner = m_maxVolCorner;
+        m_sliceState.m_minCorner = m_minVolCorner;
+        m_sliceState.m_maxTexCoord = m_maxTexCoord;
+        m_sliceState.m_minTexCoord = m_minTexCoord;
+
+        // Start with the clipping plane just outside of the volume
+        m_sliceState.m_clipPlane.m_offset = (m_maxVolCorner - m_minVolCorner).length() / 2.0;
+        m_pendingSliceState = m_sliceState;
+
+        m_updateClock.start(true);
     }
     
-    cTexture2dPtr volMatCap = cTexture2d::create();
-    if(volMatCap->loadFromFile(volumeMatcapFilepath)){
-        m_volumeObject->getInternalVolume()->m_aoTexture = volMatCap;
-        m_volumeObject->getInternalVolume()->m_aoTexture->setTextureUnit(GL_TEXTURE5);
+    // The matcap is decoded in the background and installed by updateVolume once ready
+    ifstream matcapFile(volumeMatcapFilepath.c_str());
+    if (!matcapFile.good()){
+        cerr << "FAILED TO LOAD VOLUME'S MATCAP TEXTURE" << endl;
+        cerr << volumeMatcapFilepath << endl;
+        return false;
+    }
+    m_matcapFilepath = volumeMatcapFilepath;
+    m_matcapFuture = TextureCache::getInstance()->request(volumeMatcapFilepath);
+    m_matcapPending = true;
+
+    m_initTime = initClock.getCurrentTimeSeconds();
+    cerr << "LOADING VOLUME'S MATCAP TEXTURE IN THE BACKGROUND" << endl;
+    return true;
+}
+
+
+void VolumeManager::installMatcap()
+{
+    if (!TextureCache::isReady(m_matcapFuture)){
+        return;
+    }
+    m_matcapPending = false;
+
+    TextureLoadResult result = m_matcapFuture.get();
+    if (result.m_success){
+        m_voxelObj->m_aoTexture = result.m_texture;
+        m_voxelObj->m_aoTexture->setTextureUnit(GL_TEXTURE5);
         cerr << "SUCCESFULLY LOADED VOLUME'S MATCAP TEXTURE" << endl;
-        return true;
+        cerr << "INFO! Matcap decoded in " << result.m_loadTime * 1000.0 << " ms off the init path (initVolume took "
+             << m_initTime * 1000.0 << " ms)" << endl;
     }
     else{
         cerr << "FAILED TO LOAD VOLUME'S MATCAP TEXTURE" << endl;
-        cerr << volumeMatcapFilepath << endl;
-        return false;
+        cerr << m_matcapFilepath << endl;
     }
 }
 
 
-void VolumeManager::sliceVolume(int axisIdx, double delta)
+void VolumeManager::setUpdateRate(double a_rate){
+    if (a_rate > 0.0){
+        m_minUpdatePeriod = 1.0 / a_rate;
+    }
+    else{
+        m_minUpdatePeriod = 0.0;
+    }
+}
+
+
+void VolumeManager::setSliceMode(VolumeSliceMode a_mode){
+    m_sliceState.m_mode = a_mode;
+    m_sliceState.m_clipPlane.m_enabled = (a_mode == VolumeSliceMode::PLANE);
+    commitSliceState();
+}
+
+
+VolumeSliceMode VolumeManager::cycleSliceMode(){
+    setSliceMode(VolumeSliceMode((int(m_sliceState.m_mode) + 1) % 3));
+    return m_sliceState.m_mode;
+}
+
+
+void VolumeManager::toggleCropFaces(){
+    m_sliceState.m_cropMaxFaces = !m_sliceState.m_cropMaxFaces;
+    commitSliceState();
+}
+
+
+string VolumeManager::getSliceModeName(const VolumeSliceState& a_state){
+    switch (a_state.m_mode){
+    case VolumeSliceMode::BOX:
+        return a_state.m_cropMaxFaces ? "BOX (max faces)" : "BOX (min faces)";
+    case VolumeSliceMode::PLANE:
+        return "PLANE";
+    default:
+        return "SYMMETRIC";
+    }
+}
+
+
+bool VolumeManager::sliceVolume(int axisIdx, double delta)
 {
+    SPACENAV_TRACE_SCOPE("VolumeManager::sliceVolume");
     // using following variables: m_voxelObj, m_maxVolCorner, m_textureCoordScale
     string axis_str = "";
     if (axisIdx == 0){
@@ -108,7 +189,7 @@ void VolumeManager::sliceVolume(int axisIdx, double delta)
     }
     else{
         cerr << "ERROR! Volume axis index should be either 0, 1 or 2" << endl;
-        return;
+        return false;
     }
 
     string delta_dir_str = "";
@@ -119,11 +200,435 @@ void VolumeManager::sliceVolume(int axisIdx, double delta)
         delta_dir_str = "Decrease";
     }
 
-    double value = cClamp((m_voxelObj->m_maxCorner(axisIdx) + delta), 0.01, m_maxVolCorner(axisIdx));
-    m_voxelObj->m_maxCorner(axisIdx) = value;
-    m_voxelObj->m_minCorner(axisIdx) = -value;
-    m_voxelObj->m_maxTextureCoord(axisIdx) = 0.5 + value * m_textureCoordScale(axisIdx);
-    m_voxelObj->m_minTextureCoord(axisIdx) = 0.5 - value * m_textureCoordScale(axisIdx);
+    double value = cClamp((m_sliceState.m_maxCorner(axisIdx) + delta), 0.01, m_maxVolCorner(axisIdx));
+
+    // Nothing to do if the clamped value did not change (zero delta or already at the limit)
+    if (value == m_sliceState.m_maxCorner(axisIdx)){
+        return false;
+    }
+
+    m_lastSliceAxis = axisIdx;
+    m_sliceState.m_maxCorner(axisIdx) = value;
+    m_sliceState.m_minCorner(axisIdx) = -value;
+    m_sliceState.m_maxTexCoord(axisIdx) = 0.5 + value * m_textureCoordScale(axisIdx);
+    m_sliceState.m_minTexCoord(axisIdx) = 0.5 - value * m_textureCoordScale(axisIdx);
+
+    commitSliceState();
 
     // cerr << "> " << delta_dir_str << " Volume size along " << axis_str << " axis." << endl;
-}
\ No newline at end of file
+    return true;
+}
+
+
+bool VolumeManager::cropVolume(const cVector3d& a_delta)
+{
+    SPACENAV_TRACE_SCOPE("VolumeManager::cropVolume");
+    // Every axis of the device moves its own face, so the crop box can be changed in one gesture
+    bool changed = false;
+    for (int axisIdx = 0; axisIdx < 3; axisIdx++){
+        if (cropFace(axisIdx, m_sliceState.m_cropMaxFaces, a_delta(axisIdx))){
+            if (!changed || fabs(a_delta(axisIdx)) > fabs(a_delta(m_lastSliceAxis))){
+                m_lastSliceAxis = axisIdx;
+            }
+            changed = true;
+        }
+    }
+
+    if (changed){
+        commitSliceState();
+    }
+    return changed;
+}
+
+
+bool VolumeManager::cropFace(int axisIdx, bool maxFace, double delta)
+{
+    double value;
+    if (maxFace){
+        value = cClamp(m_sliceState.m_maxCorner(axisIdx) + delta, m_sliceState.m_minCorner(axisIdx) + m_minThickness, m_maxVolCorner(axisIdx));
+        if (value == m_sliceState.m_maxCorner(axisIdx)){
+            return false;
+        }
+        m_sliceState.m_maxCorner(axisIdx) = value;
+    }
+    else{
+        value = cClamp(m_sliceState.m_minCorner(axisIdx) + delta, m_minVolCorner(axisIdx), m_sliceState.m_maxCorner(axisIdx) - m_minThickness);
+        if (value == m_sliceState.m_minCorner(axisIdx)){
+            return false;
+        }
+        m_sliceState.m_minCorner(axisIdx) = value;
+    }
+
+    updateTextureCoord(axisIdx);
+    return true;
+}
+
+
+void VolumeManager::updateTextureCoord(int axisIdx)
+{
+    m_sliceState.m_maxTexCoord(axisIdx) = m_minTexCoord(axisIdx) + (m_sliceState.m_maxCorner(axisIdx) - m_minVolCorner(axisIdx)) * m_textureCoordScale(axisIdx);
+    m_sliceState.m_minTexCoord(axisIdx) = m_minTexCoord(axisIdx) + (m_sliceState.m_minCorner(axisIdx) - m_minVolCorner(axisIdx)) * m_textureCoordScale(axisIdx);
+}
+
+
+bool VolumeManager::moveClipPlane(const cVector3d& a_deltaPos, const cMatrix3d& a_deltaRot)
+{
+    SPACENAV_TRACE_SCOPE("VolumeManager::moveClipPlane");
+    VolumeClipPlane& plane = m_sliceState.m_clipPlane;
+
+    // Rotate the plane about the volume center and push it along its normal
+    cVector3d normal = a_deltaRot * plane.m_normal;
+    normal.normalize();
+    double limit = (m_maxVolCorner - m_minVolCorner).length() / 2.0;
+    double offset = cClamp(plane.m_offset + cDot(normal, a_deltaPos), -limit, limit);
+
+    if (normal.equals(plane.m_normal, 0.0) && offset == plane.m_offset){
+        return false;
+    }
+
+    plane.m_normal = normal;
+    plane.m_offset = offset;
+    commitSliceState();
+    return true;
+}
+
+
+void VolumeManager::commitSliceState()
+{
+    // Hand the new state over to the graphics thread
+    m_mutexVoxel.acquire();
+    m_pendingSliceState = m_sliceState;
+    m_flagMarkVolumeForUpdate = true;
+    m_mutexVoxel.release();
+
+    if (m_sliceImageEnabled){
+        m_sliceResampler.requestSlice(computeSlicePlane());
+    }
+    if (m_statisticsEnabled){
+        m_voxelStatistics.requestUpdate(computeVoxelBox(m_sliceState));
+    }
+}
+
+
+VolumeSliceState VolumeManager::getCommittedSliceState()
+{
+    m_mutexVoxel.acquire();
+    VolumeSliceState state = m_pendingSliceState;
+    m_mutexVoxel.release();
+    return state;
+}
+
+
+void VolumeManager::initWorkerPool(int a_numThreads)
+{
+    // The pool is shared by the slice image and the statistics
+    if (!m_workerPoolReady){
+        m_workerPool.init(a_numThreads);
+        m_workerPoolReady = true;
+    }
+}
+
+
+void VolumeManager::startVoxelCopy()
+{
+    // The voxels are shared by the slice image and the statistics, only copy them once
+    if (m_voxelLoadThread.joinable()){
+        return;
+    }
+
+    // Copy the voxels in the background. Requests that arrive before the copy is done are skipped
+    m_voxelLoadThread = thread([this](){
+        cPrecisionClock clock;
+        clock.start(true);
+        bool loaded;
+        {
+            lock_guard<mutex> lock(m_imageMutex);
+            loaded = m_voxelGrid.loadFromVolume(m_voxelObj, &m_workerPool);
+        }
+        if (loaded){
+            cerr << "INFO! Copied " << m_voxelGrid.m_size[0] << "x" << m_voxelGrid.m_size[1] << "x" << m_voxelGrid.m_size[2]
+                 << " voxels in " << clock.getCurrentTimeSeconds() * 1000.0 << " ms" << endl;
+
+            // Statistics of the initial crop box
+            if (m_statisticsEnabled){
+                m_voxelStatistics.requestUpdate(computeVoxelBox(getCommittedSliceState()));
+            }
+        }
+    });
+}
+
+
+bool VolumeManager::initSliceImage(int a_numThreads, int a_width, int a_height, SliceImageCallback a_callback)
+{
+    if (!m_voxelObj){
+        cerr << "ERROR! VOLUME MUST BE INITIALIZED BEFORE THE SLICE IMAGE" << endl;
+        return false;
+    }
+
+    initWorkerPool(a_numThreads);
+    if (!m_sliceResampler.init(&m_voxelGrid, &m_workerPool, a_width, a_height, a_callback)){
+        return false;
+    }
+
+    m_sliceImageEnabled = true;
+    startVoxelCopy();
+    cerr << "INFO! Slice image: " << a_width << "x" << a_height << " on " << m_workerPool.getNumThreads() << " threads" << endl;
+    return true;
+}
+
+
+bool VolumeManager::initStatistics(int a_numThreads, int a_threshold, VoxelStatisticsCallback a_callback)
+{
+    if (!m_voxelObj){
+        cerr << "ERROR! VOLUME MUST BE INITIALIZED BEFORE THE STATISTICS" << endl;
+        return false;
+    }
+
+    initWorkerPool(a_numThreads);
+    if (!m_voxelStatistics.init(&m_voxelGrid, &m_workerPool, a_threshold, a_callback)){
+        return false;
+    }
+
+    m_statisticsEnabled = true;
+    startVoxelCopy();
+
+    // The voxels may already have been copied for the slice image
+    if (m_voxelGrid.isReady()){
+        m_voxelStatistics.requestUpdate(computeVoxelBox(m_sliceState));
+    }
+
+    cerr << "INFO! Voxel statistics with threshold " << a_threshold << endl;
+    return true;
+}
+
+
+VoxelBox VolumeManager::computeVoxelBox(const VolumeSliceState& a_state)
+{
+    // Voxels whose center lies inside the crop box
+    VoxelBox box;
+    for (int i = 0; i < 3; i++){
+        int size = m_voxelGrid.m_size[i];
+        box.m_min[i] = cClamp(int(ceil(a_state.m_minTexCoord(i) * size - 0.5)), 0, size);
+        box.m_max[i] = cClamp(int(floor(a_state.m_maxTexCoord(i) * size - 0.5)) + 1, 0, size);
+    }
+    return box;
+}
+
+
+cVector3d VolumeManager::toTextureCoord(const cVector3d& a_localPos)
+{
+    cVector3d texCoord;
+    for (int i = 0; i < 3; i++){
+        texCoord(i) = m_minTexCoord(i) + (a_localPos(i) - m_minVolCorner(i)) * m_textureCoordScale(i);
+    }
+    return texCoord;
+}
+
+
+SlicePlane VolumeManager::computeSlicePlane()
+{
+    SlicePlane slicePlane;
+
+    if (m_sliceState.m_clipPlane.m_enabled){
+        // Square that covers the whole volume, centered on the clipping plane
+        const VolumeClipPlane& plane = m_sliceState.m_clipPlane;
+        cVector3d helper = fabs(plane.m_normal.x()) < 0.9 ? cVector3d(1.0, 0.0, 0.0) : cVector3d(0.0, 1.0, 0.0);
+        cVector3d uDir = cCross(helper, plane.m_normal);
+        uDir.normalize();
+        cVector3d vDir = cCross(plane.m_normal, uDir);
+        double halfExtent = (m_maxVolCorner - m_minVolCorner).length() / 2.0;
+
+        cVector3d corner = plane.m_normal * plane.m_offset - uDir * halfExtent - vDir * halfExtent;
+        slicePlane.m_origin = toTextureCoord(corner);
+        slicePlane.m_u = toTextureCoord(corner + uDir * 2.0 * halfExtent) - slicePlane.m_origin;
+        slicePlane.m_v = toTextureCoord(corner + vDir * 2.0 * halfExtent) - slicePlane.m_origin;
+    }
+    else{
+        // Cut face at the max corner along the last sliced axis, spanning the crop box
+        int a = m_lastSliceAxis, b = (a + 1) % 3, c = (a + 2) % 3;
+        slicePlane.m_origin = m_sliceState.m_minTexCoord;
+        slicePlane.m_origin(a) = m_sliceState.m_maxTexCoord(a);
+        slicePlane.m_u.set(0.0, 0.0, 0.0);
+        slicePlane.m_u(b) = m_sliceState.m_maxTexCoord(b) - m_sliceState.m_minTexCoord(b);
+        slicePlane.m_v.set(0.0, 0.0, 0.0);
+        slicePlane.m_v(c) = m_sliceState.m_maxTexCoord(c) - m_sliceState.m_minTexCoord(c);
+    }
+
+    return slicePlane;
+}
+
+
+void VolumeManager::close()
+{
+    m_sliceImageEnabled = false;
+    m_statisticsEnabled = false;
+    if (m_voxelLoadThread.joinable()){
+        m_voxelLoadThread.join();
+    }
+    m_sliceResampler.close();
+    m_voxelStatistics.close();
+    m_workerPool.close();
+    m_workerPoolReady = false;
+}
+
+
+void VolumeManager::updateVolume()
+{
+    if (!m_voxelObj){
+        return;
+    }
+
+    if (m_matcapPending){
+        installMatcap();
+    }
+
+    // Limit the rate at which the rendered volume is updated
+    double time = m_updateClock.getCurrentTimeSeconds();
+    if (time - m_lastUpdateTime < m_minUpdatePeriod){
+        return;
+    }
+
+    m_mutexVoxel.acquire();
+    bool updated = m_flagMarkVolumeForUpdate;
+    if (updated){
+        m_voxelObj->m_maxCorner = m_pendingSliceState.m_maxCorner;
+        m_voxelObj->m_minCorner = m_pendingSliceState.m_minCorner;
+        m_voxelObj->m_maxTextureCoord = m_pendingSliceState.m_maxTexCoord;
+        m_voxelObj->m_minTextureCoord = m_pendingSliceState.m_minTexCoord;
+        m_targetClipPlane = m_pendingSliceState.m_clipPlane;
+        m_flagMarkVolumeForUpdate = false;
+    }
+    m_mutexVoxel.release();
+
+    // The texture is only rewritten when the plane moved. While the voxels are being copied
+    // the clipping waits for a later frame instead of blocking the rendering
+    if (!m_targetClipPlane.equals(m_appliedClipPlane)){
+        unique_lock<mutex> lock(m_imageMutex, try_to_lock);
+        if (lock.owns_lock()){
+            applyClipPlane(m_targetClipPlane);
+            m_appliedClipPlane = m_targetClipPlane;
+            updated = true;
+        }
+    }
+
+    if (updated){
+        m_lastUpdateTime = time;
+    }
+}
+
+
+// The voxels on the far side of the plane are made transparent in the texture. Along each row of
+// the volume the kept voxels are one interval, so only the voxels between the previous and the
+// new bounds of the interval are touched
+void VolumeManager::applyClipPlane(const VolumeClipPlane& a_plane)
+{
+    SPACENAV_TRACE_SCOPE("VolumeManager::applyClipPlane");
+    cMultiImagePtr image = dynamic_pointer_cast<cMultiImage>(m_voxelObj->m_texture->m_image);
+    if (!image){
+        return;
+    }
+    int size[3] = {int(image->getWidth()), int(image->getHeight()), int(image->getImageCount())};
+    int rowCount = size[1] * size[2];
+    if (m_clipSpans.empty()){
+        if (!a_plane.m_enabled){
+            return;
+        }
+        m_clipSpans.resize(2 * size_t(rowCount));
+        for (int r = 0; r < rowCount; r++){
+            m_clipSpans[2 * r] = 0;
+            m_clipSpans[2 * r + 1] = size[0];
+        }
+        m_clipAlpha.assign(size_t(size[0]) * rowCount, 0);
+    }
+
+    // Center of the voxel i along an axis in the volume local frame: origin + i * step
+    double origin[3], step[3];
+    for (int i = 0; i < 3; i++){
+        origin[i] = m_minVolCorner(i) + (0.5 / size[i] - m_minTexCoord(i)) / m_textureCoordScale(i);
+        step[i] = 1.0 / (size[i] * m_textureCoordScale(i));
+    }
+    const cVector3d& normal = a_plane.m_normal;
+    double slope = normal.x() * step[0];
+
+    int lower[3] = {size[0], size[1], size[2]};
+    int upper[3] = {-1, -1, -1};
+    cColorb color;
+    for (int z = 0; z < size[2]; z++){
+        for (int y = 0; y < size[1]; y++){
+            // Kept voxels [begin, end) of the row, where dot(normal, p) <= offset
+            int begin = 0, end = size[0];
+            if (a_plane.m_enabled){
+                double rest = a_plane.m_offset - normal.x() * origin[0] - normal.y() * (origin[1] + y * step[1]) - normal.z() * (origin[2] + z * step[2]);
+                if (fabs(slope) < 1e-12){
+                    end = rest < 0.0 ? 0 : size[0];
+                }
+                else if (slope > 0.0){
+                    end = int(cClamp(floor(rest / slope) + 1.0, 0.0, double(size[0])));
+                }
+                else{
+                    begin = int(cClamp(ceil(rest / slope), 0.0, double(size[0])));
+                }
+                begin = min(begin, end);
+            }
+
+            int r = y + size[1] * z;
+            int oldBegin = m_clipSpans[2 * r], oldEnd = m_clipSpans[2 * r + 1];
+            if (begin == oldBegin && end == oldEnd){
+                continue;
+            }
+            m_clipSpans[2 * r] = begin;
+            m_clipSpans[2 * r + 1] = end;
+
+            // Outside of the voxels kept by both intervals. Disjoint intervals need the whole row
+            int keptBegin = max(begin, oldBegin), keptEnd = min(end, oldEnd);
+            int ranges[2][2] = {{min(begin, oldBegin), keptBegin}, {keptEnd, max(end, oldEnd)}};
+            if (keptBegin >= keptEnd){
+                ranges[0][0] = 0;
+                ranges[0][1] = size[0];
+                ranges[1][0] = ranges[1][1] = 0;
+            }
+            for (int k = 0; k < 2; k++){
+                for (int x = ranges[k][0]; x < ranges[k][1]; x++){
+                    bool wasKept = x >= oldBegin && x < oldEnd;
+                    bool kept = x >= begin && x < end;
+                    if (wasKept == kept){
+                        continue;
+                    }
+                    // Keep the alpha of the removed voxels to restore them. The drilling removes a
+                    // voxel by writing the zero color, so a voxel drilled while it was clipped stays
+                    // removed (as does a black voxel, whose alpha cannot be told apart)
+                    size_t index = size_t(x) + size_t(size[0]) * r;
+                    image->getVoxelColor(x, y, z, color);
+                    if (!kept){
+                        m_clipAlpha[index] = color.getA();
+                        color.setA(0);
+                    }
+                    else if (color.getR() || color.getG() || color.getB()){
+                        color.setA(m_clipAlpha[index]);
+                    }
+                    else{
+                        continue;
+                    }
+                    image->setVoxelColor(x, y, z, color);
+                    lower[0] = min(lower[0], x);
+                    upper[0] = max(upper[0], x);
+                    lower[1] = min(lower[1], y);
+                    upper[1] = max(upper[1], y);
+                    lower[2] = min(lower[2], z);
+                    upper[2] = max(upper[2], z);
+                }
+            }
+        }
+    }
+
+    // Only upload the part of the texture that changed
+    if (upper[0] >= 0){
+        m_voxelObj->m_texture->markForPartialUpdate(cVector3d(lower[0], lower[1], lower[2]), cVector3d(upper[0], upper[1], upper[2]));
+    }
+
+    // Every voxel is restored once the plane is disabled, so the copies are not needed anymore
+    if (!a_plane.m_enabled){
+        vector<int>().swap(m_clipSpans);
+        vector<uint8_t>().swap(m_clipAlpha);
+    }
+}
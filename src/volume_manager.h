@@ -48,26 +48,136 @@
 // To silence warnings on MacOS
 #define GL_SILENCE_DEPRECATION
 #include <afFramework.h>
+#include <mutex>
+#include "slice_resampler.h"
+#include "texture_cache.h"
+#include "tracer.h"
+#include "voxel_statistics.h"
 
 using namespace std;
 using namespace ambf;
 
+enum class VolumeSliceMode{
+    SYMMETRIC=0, // Shrink the volume symmetrically about its center along the dominant axis
+    BOX=1, // Move the faces of the crop box independently
+    PLANE=2 // Move an oblique clipping plane that follows the device rotation
+};
+
+// Clipping plane n.p <= d expressed in the volume local frame
+struct VolumeClipPlane{
+    cVector3d m_normal = cVector3d(0.0, 0.0, 1.0);
+    double m_offset = 0.0;
+    bool m_enabled = false;
+
+    // Disabled planes are all the same
+    bool equals(const VolumeClipPlane& a_other) const{
+        return m_enabled == a_other.m_enabled && (!m_enabled || (m_normal.equals(a_other.m_normal, 0.0) && m_offset == a_other.m_offset));
+    }
+};
+
+// Mode, corners, texture coordinates and clipping plane of the sliced volume
+struct VolumeSliceState{
+    VolumeSliceMode m_mode = VolumeSliceMode::SYMMETRIC;
+    bool m_cropMaxFaces = true; // In BOX mode, move the max faces (true) or the min faces (false) of the crop box
+    cVector3d m_maxCorner, m_minCorner;
+    cVector3d m_maxTexCoord, m_minTexCoord;
+    VolumeClipPlane m_clipPlane;
+};
+
 class VolumeManager{
     public:
         VolumeManager();
         bool initVolume(afWorldPtr a_worldPtr, string volume_name, string volumeMatcapFilepath);
-        void sliceVolume(int axisIdx, double delta);
+        void setUpdateRate(double a_rate);
+
+        // Called from the physics thread
+        void setSliceMode(VolumeSliceMode a_mode);
+        VolumeSliceMode cycleSliceMode();
+        VolumeSliceMode getSliceMode() const{ return m_sliceState.m_mode; }
+        void toggleCropFaces();
+        static string getSliceModeName(const VolumeSliceState& a_state);
+
+        // Called from any thread. Latest slicing state handed to the graphics thread
+        VolumeSliceState getCommittedSliceState();
+
+        // Called from the physics thread. Return true if the slicing state changed
+        bool sliceVolume(int axisIdx, double delta);
+        bool cropVolume(const cVector3d& a_delta);
+        bool moveClipPlane(const cVector3d& a_deltaPos, const cMatrix3d& a_deltaRot);
+
+        // Called from the graphics thread. Applies the latest slicing state to the volume
+        void updateVolume();
+
+        // Stream the cut face of the volume as a 2D image to a_callback (called from the resampler thread)
+        bool initSliceImage(int a_numThreads, int a_width, int a_height, SliceImageCallback a_callback);
+        SlicePlane computeSlicePlane();
+
+        // Stream the statistics of the voxels inside the crop box to a_callback (called from the statistics thread)
+        bool initStatistics(int a_numThreads, int a_threshold, VoxelStatisticsCallback a_callback);
+        VoxelBox computeVoxelBox(const VolumeSliceState& a_state);
+
+        void close();
 
         afWorldPtr m_worldPtr;
         afVolumePtr m_volumeObject;
-        bool m_flagMarkVolumeForUpdate = true;
-        cVoxelObject* m_voxelObj;
+        bool m_flagMarkVolumeForUpdate = false;
+        cVoxelObject* m_voxelObj = nullptr;
         cVector3d m_maxVolCorner, m_minVolCorner;
         cVector3d m_maxTexCoord, m_minTexCoord;
         cVector3d m_textureCoordScale; // Scale between volume corners extent and texture coordinates extent
 
+        // Slicing state owned by the physics thread
+        VolumeSliceState m_sliceState;
+
+        // Slicing state handed to the graphics thread (guarded by m_mutexVoxel)
+        VolumeSliceState m_pendingSliceState;
+
+        // Thinnest crop box allowed along each axis
+        double m_minThickness = 0.01;
+
+        // Minimum period between two updates of the rendered volume. 0 means every frame
+        double m_minUpdatePeriod = 0.0;
+        double m_lastUpdateTime = 0.0;
+        cPrecisionClock m_updateClock;
+
         cMutex m_mutexVoxel;    
         cCollisionAABBBox m_volumeUpdate;
+
+        // Matcap texture being decoded in the background
+        TextureFuture m_matcapFuture;
+        string m_matcapFilepath;
+        bool m_matcapPending = false;
+        double m_initTime = 0.0; // Time spent in initVolume [s]
+
+        // Multi-planar reconstruction of the cut face
+        WorkerPool m_workerPool;
+        bool m_workerPoolReady = false;
+        VoxelGrid m_voxelGrid;
+        SliceResampler m_sliceResampler;
+        thread m_voxelLoadThread;
+        VoxelStatisticsTracker m_voxelStatistics;
+        bool m_sliceImageEnabled = false;
+        bool m_statisticsEnabled = false;
+        int m_lastSliceAxis = 2; // Axis of the cut face that is streamed in SYMMETRIC and BOX modes
+
+        // Clipping of the voxels by the plane, on the graphics thread. Allocated while the plane is enabled
+        vector<int> m_clipSpans; // Kept voxels [begin, end) along x of every row (y, z)
+        vector<uint8_t> m_clipAlpha; // Alpha of the voxels made transparent by the plane
+        VolumeClipPlane m_targetClipPlane; // Latest plane handed over
+        VolumeClipPlane m_appliedClipPlane; // Plane the texture is clipped by
+
+        // Held by the voxel copy and the clipping, which read and write the same image
+        mutex m_imageMutex;
+
+    protected:
+        void installMatcap();
+        bool cropFace(int axisIdx, bool maxFace, double delta);
+        void updateTextureCoord(int axisIdx);
+        void commitSliceState();
+        void applyClipPlane(const VolumeClipPlane& a_plane);
+        cVector3d toTextureCoord(const cVector3d& a_localPos);
+        void initWorkerPool(int a_numThreads);
+        void startVoxelCopy();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,87 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+
+#include "voxel_grid.h"
+
+using namespace std;
+
+VoxelGrid::VoxelGrid(){
+    m_ready = false;
+}
+
+bool VoxelGrid::loadFromVolume(cVoxelObject* a_voxelObj, WorkerPool* a_pool){
+    m_ready = false;
+    if (!a_voxelObj || !a_voxelObj->m_texture){
+        cerr << "ERROR! VOLUME HAS NO VOXEL TEXTURE" << endl;
+        return false;
+    }
+
+    cMultiImagePtr image = dynamic_pointer_cast<cMultiImage>(a_voxelObj->m_texture->m_image);
+    if (!image){
+        cerr << "ERROR! VOLUME TEXTURE IS NOT A MULTI IMAGE" << endl;
+        return false;
+    }
+
+    m_size[0] = image->getWidth();
+    m_size[1] = image->getHeight();
+    m_size[2] = image->getImageCount();
+    m_data.assign(size_t(m_size[0]) * m_size[1] * m_size[2], 0);
+
+    // Copy the voxels slab by slab in parallel
+    a_pool->parallelFor(m_size[2], [&](int a_begin, int a_end, int){
+        cColorb color;
+        for (int z = a_begin; z < a_end; z++){
+            for (int y = 0; y < m_size[1]; y++){
+                uint8_t* row = &m_data[index(0, y, z)];
+                for (int x = 0; x < m_size[0]; x++){
+                    image->getVoxelColor(x, y, z, color);
+                    if (color.getA() > 0){
+                        row[x] = uint8_t((int(color.getR()) + int(color.getG()) + int(color.getB())) / 3);
+                    }
+                }
+            }
+        }
+    });
+
+    m_ready.store(true, memory_order_release);
+    return true;
+}
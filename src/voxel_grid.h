@@ -0,0 +1,79 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+#ifndef VOXEL_GRID_H
+#define VOXEL_GRID_H
+
+// To silence warnings on MacOS
+#define GL_SILENCE_DEPRECATION
+#include <afFramework.h>
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+#include "worker_pool.h"
+
+using namespace chai3d;
+using namespace std;
+
+// Contiguous 8 bit intensity copy of the voxels of a cVoxelObject (x fastest, then y, then z).
+// Voxels with zero alpha (e.g. removed by drilling) have zero intensity.
+class VoxelGrid{
+    public:
+        VoxelGrid();
+
+        bool loadFromVolume(cVoxelObject* a_voxelObj, WorkerPool* a_pool);
+        bool isReady() const { return m_ready.load(memory_order_acquire); }
+
+        inline size_t index(int a_x, int a_y, int a_z) const {
+            return size_t(a_x) + size_t(m_size[0]) * (size_t(a_y) + size_t(m_size[1]) * size_t(a_z));
+        }
+        inline uint8_t get(int a_x, int a_y, int a_z) const { return m_data[index(a_x, a_y, a_z)]; }
+        inline const uint8_t* data() const { return m_data.data(); }
+
+        int m_size[3] = {0, 0, 0};
+
+    private:
+        vector<uint8_t> m_data;
+        atomic<bool> m_ready;
+};
+
+#endif //VOXEL_GRID_H
@@ -0,0 +1,276 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+
+#include "voxel_statistics.h"
+#include <cstring>
+
+using namespace std;
+
+bool VoxelBox::isEmpty() const{
+    return m_max[0] <= m_min[0] || m_max[1] <= m_min[1] || m_max[2] <= m_min[2];
+}
+
+long long VoxelBox::getCount() const{
+    if (isEmpty()){
+        return 0;
+    }
+    return (long long)(m_max[0] - m_min[0]) * (m_max[1] - m_min[1]) * (m_max[2] - m_min[2]);
+}
+
+bool VoxelBox::equals(const VoxelBox& a_box) const{
+    for (int i = 0; i < 3; i++){
+        if (m_min[i] != a_box.m_min[i] || m_max[i] != a_box.m_max[i]){
+            return false;
+        }
+    }
+    return true;
+}
+
+VoxelStatisticsTracker::VoxelStatisticsTracker(){
+    memset(m_histogram, 0, sizeof(m_histogram));
+}
+
+VoxelStatisticsTracker::~VoxelStatisticsTracker(){
+    close();
+}
+
+bool VoxelStatisticsTracker::init(VoxelGrid* a_grid, WorkerPool* a_pool, int a_threshold, VoxelStatisticsCallback a_callback){
+    if (!a_grid || !a_pool){
+        cerr << "ERROR! INVALID VOXEL STATISTICS PARAMETERS" << endl;
+        return false;
+    }
+
+    close();
+    m_grid = a_grid;
+    m_pool = a_pool;
+    m_threshold = cClamp(a_threshold, 0, 255);
+    m_callback = a_callback;
+    m_box = VoxelBox();
+    memset(m_histogram, 0, sizeof(m_histogram));
+    m_workerHistograms.assign(size_t(m_pool->getNumThreads()) * 4 * 256, 0);
+
+    m_running = true;
+    m_thread = thread(&VoxelStatisticsTracker::updateLoop, this);
+    return true;
+}
+
+void VoxelStatisticsTracker::close(){
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_condition.notify_all();
+    if (m_thread.joinable()){
+        m_thread.join();
+    }
+}
+
+void VoxelStatisticsTracker::requestUpdate(const VoxelBox& a_box){
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_requestedBox = a_box;
+        m_hasRequest = true;
+    }
+    m_condition.notify_one();
+}
+
+void VoxelStatisticsTracker::updateLoop(){
+    VoxelStatistics statistics;
+    while (true){
+        VoxelBox box;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]{ return !m_running || m_hasRequest; });
+            if (!m_running){
+                return;
+            }
+            box = m_requestedBox;
+            m_hasRequest = false;
+        }
+
+        if (!m_grid->isReady()){
+            continue;
+        }
+
+        update(box);
+        if (m_callback){
+            getStatistics(statistics);
+            m_callback(statistics);
+        }
+    }
+}
+
+void VoxelStatisticsTracker::subtractBox(const VoxelBox& a_box, const VoxelBox& a_other, vector<VoxelBox>& a_result){
+    a_result.clear();
+    if (a_box.isEmpty()){
+        return;
+    }
+
+    VoxelBox overlap;
+    for (int i = 0; i < 3; i++){
+        overlap.m_min[i] = max(a_box.m_min[i], a_other.m_min[i]);
+        overlap.m_max[i] = min(a_box.m_max[i], a_other.m_max[i]);
+    }
+    if (overlap.isEmpty()){
+        a_result.push_back(a_box);
+        return;
+    }
+
+    // Peel off the slabs below and above the overlap, one axis at a time
+    VoxelBox remaining = a_box;
+    for (int i = 0; i < 3; i++){
+        if (remaining.m_min[i] < overlap.m_min[i]){
+            VoxelBox slab = remaining;
+            slab.m_max[i] = overlap.m_min[i];
+            a_result.push_back(slab);
+            remaining.m_min[i] = overlap.m_min[i];
+        }
+        if (remaining.m_max[i] > overlap.m_max[i]){
+            VoxelBox slab = remaining;
+            slab.m_min[i] = overlap.m_max[i];
+            a_result.push_back(slab);
+            remaining.m_max[i] = overlap.m_max[i];
+        }
+    }
+}
+
+void VoxelStatisticsTracker::update(const VoxelBox& a_box){
+    if (a_box.equals(m_box)){
+        return;
+    }
+
+    vector<VoxelBox> added, removed;
+    subtractBox(a_box, m_box, added);
+    subtractBox(m_box, a_box, removed);
+
+    long long changed = 0;
+    for (size_t i = 0; i < added.size(); i++){
+        changed += added[i].getCount();
+    }
+    for (size_t i = 0; i < removed.size(); i++){
+        changed += removed[i].getCount();
+    }
+
+    if (changed >= a_box.getCount()){
+        // Cheaper to rescan the new box
+        memset(m_histogram, 0, sizeof(m_histogram));
+        accumulate(a_box, 1);
+    }
+    else{
+        for (size_t i = 0; i < added.size(); i++){
+            accumulate(added[i], 1);
+        }
+        for (size_t i = 0; i < removed.size(); i++){
+            accumulate(removed[i], -1);
+        }
+    }
+    m_box = a_box;
+}
+
+void VoxelStatisticsTracker::accumulate(const VoxelBox& a_box, long long a_sign){
+    if (a_box.isEmpty()){
+        return;
+    }
+
+    int numWorkers = m_pool->getNumThreads();
+    fill(m_workerHistograms.begin(), m_workerHistograms.end(), 0);
+
+    // Split the (y, z) rows of the box across the workers
+    int numRowsY = a_box.m_max[1] - a_box.m_min[1];
+    int numRows = numRowsY * (a_box.m_max[2] - a_box.m_min[2]);
+    m_pool->parallelFor(numRows, [&](int a_begin, int a_end, int a_worker){
+        uint32_t* h0 = &m_workerHistograms[size_t(a_worker) * 4 * 256];
+        uint32_t* h1 = h0 + 256;
+        uint32_t* h2 = h0 + 512;
+        uint32_t* h3 = h0 + 768;
+        int width = a_box.m_max[0] - a_box.m_min[0];
+
+        for (int row = a_begin; row < a_end; row++){
+            int y = a_box.m_min[1] + row % numRowsY;
+            int z = a_box.m_min[2] + row / numRowsY;
+            const uint8_t* data = m_grid->data() + m_grid->index(a_box.m_min[0], y, z);
+
+            // 4 partial histograms so that consecutive equal voxels do not serialize on one counter
+            int x = 0;
+            for (; x + 4 <= width; x += 4){
+                uint32_t word;
+                memcpy(&word, data + x, 4);
+                h0[word & 0xFF]++;
+                h1[(word >> 8) & 0xFF]++;
+                h2[(word >> 16) & 0xFF]++;
+                h3[word >> 24]++;
+            }
+            for (; x < width; x++){
+                h0[data[x]]++;
+            }
+        }
+    });
+
+    for (int w = 0; w < numWorkers; w++){
+        const uint32_t* h = &m_workerHistograms[size_t(w) * 4 * 256];
+        for (int bin = 0; bin < 256; bin++){
+            m_histogram[bin] += a_sign * ((long long)h[bin] + h[bin + 256] + h[bin + 512] + h[bin + 768]);
+        }
+    }
+}
+
+void VoxelStatisticsTracker::getStatistics(VoxelStatistics& a_statistics){
+    memcpy(a_statistics.m_histogram, m_histogram, sizeof(m_histogram));
+    a_statistics.m_threshold = m_threshold;
+    a_statistics.m_count = 0;
+    a_statistics.m_countAboveThreshold = 0;
+    a_statistics.m_min = -1;
+    a_statistics.m_max = -1;
+
+    for (int bin = 0; bin < 256; bin++){
+        if (m_histogram[bin] > 0){
+            if (a_statistics.m_min < 0){
+                a_statistics.m_min = bin;
+            }
+            a_statistics.m_max = bin;
+        }
+        a_statistics.m_count += m_histogram[bin];
+        if (bin > m_threshold){
+            a_statistics.m_countAboveThreshold += m_histogram[bin];
+        }
+    }
+}
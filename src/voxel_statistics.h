@@ -0,0 +1,119 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+#ifndef VOXEL_STATISTICS_H
+#define VOXEL_STATISTICS_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "voxel_grid.h"
+#include "worker_pool.h"
+
+using namespace std;
+
+// Box of voxel indices [m_min, m_max)
+struct VoxelBox{
+    int m_min[3] = {0, 0, 0};
+    int m_max[3] = {0, 0, 0};
+
+    bool isEmpty() const;
+    long long getCount() const;
+    bool equals(const VoxelBox& a_box) const;
+};
+
+struct VoxelStatistics{
+    long long m_histogram[256];
+    long long m_count = 0; // Number of voxels in the box
+    long long m_countAboveThreshold = 0;
+    int m_threshold = 0;
+    int m_min = 0;
+    int m_max = 0;
+};
+
+typedef function<void(const VoxelStatistics& a_statistics)> VoxelStatisticsCallback;
+
+// Keeps the intensity histogram of the voxels inside a crop box. When the box changes only the
+// slabs that were added or removed are scanned, with one partial histogram per worker thread.
+class VoxelStatisticsTracker{
+    public:
+        VoxelStatisticsTracker();
+        ~VoxelStatisticsTracker();
+
+        bool init(VoxelGrid* a_grid, WorkerPool* a_pool, int a_threshold, VoxelStatisticsCallback a_callback);
+        void close();
+
+        // Update the statistics on the calling thread
+        void update(const VoxelBox& a_box);
+        void getStatistics(VoxelStatistics& a_statistics);
+
+        // Update the statistics on the statistics thread and hand them to the callback.
+        // Requests that arrive while the statistics are being updated are coalesced into the latest one.
+        void requestUpdate(const VoxelBox& a_box);
+
+        // Remaining part of a_box once a_other is removed, as disjoint boxes
+        static void subtractBox(const VoxelBox& a_box, const VoxelBox& a_other, vector<VoxelBox>& a_result);
+
+    private:
+        void accumulate(const VoxelBox& a_box, long long a_sign);
+        void updateLoop();
+
+        VoxelGrid* m_grid = nullptr;
+        WorkerPool* m_pool = nullptr;
+        int m_threshold = 0;
+        VoxelStatisticsCallback m_callback;
+
+        VoxelBox m_box;
+        long long m_histogram[256];
+
+        // 4 interleaved partial histograms per worker
+        vector<uint32_t> m_workerHistograms;
+
+        thread m_thread;
+        mutex m_mutex;
+        condition_variable m_condition;
+        VoxelBox m_requestedBox;
+        bool m_hasRequest = false;
+        bool m_running = false;
+};
+
+#endif //VOXEL_STATISTICS_H
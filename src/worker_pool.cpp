@@ -0,0 +1,142 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+
+#include "worker_pool.h"
+
+using namespace std;
+
+WorkerPool::WorkerPool(){
+    m_nextChunk = 0;
+}
+
+WorkerPool::~WorkerPool(){
+    close();
+}
+
+void WorkerPool::init(int a_numThreads){
+    close();
+    if (a_numThreads <= 0){
+        a_numThreads = max(1, int(thread::hardware_concurrency()));
+    }
+
+    m_running = true;
+    // The calling thread is one of the workers
+    for (int i = 1; i < a_numThreads; i++){
+        m_threads.push_back(thread(&WorkerPool::workerLoop, this, i));
+    }
+}
+
+void WorkerPool::close(){
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_startCondition.notify_all();
+    for (size_t i = 0; i < m_threads.size(); i++){
+        m_threads[i].join();
+    }
+    m_threads.clear();
+}
+
+int WorkerPool::getNumThreads(){
+    return int(m_threads.size()) + 1;
+}
+
+void WorkerPool::parallelFor(int a_count, function<void(int, int, int)> a_func){
+    if (a_count <= 0){
+        return;
+    }
+
+    lock_guard<mutex> callLock(m_callMutex);
+    int numThreads = getNumThreads();
+    if (numThreads == 1 || a_count == 1){
+        a_func(0, a_count, 0);
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_func = a_func;
+        m_count = a_count;
+        // A few chunks per thread to even out the load
+        m_numChunks = min(a_count, numThreads * 4);
+        m_nextChunk = 0;
+        m_pending = int(m_threads.size());
+        m_generation++;
+    }
+    m_startCondition.notify_all();
+
+    // Take part in the work, then wait for the other workers
+    int chunk;
+    while ((chunk = m_nextChunk.fetch_add(1)) < m_numChunks){
+        m_func(chunk * m_count / m_numChunks, (chunk + 1) * m_count / m_numChunks, 0);
+    }
+
+    unique_lock<mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this]{ return m_pending == 0; });
+    m_func = nullptr;
+}
+
+void WorkerPool::workerLoop(int a_worker){
+    unsigned int generation = 0;
+    while (true){
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [&]{ return !m_running || m_generation != generation; });
+            if (!m_running){
+                return;
+            }
+            generation = m_generation;
+        }
+
+        int chunk;
+        while ((chunk = m_nextChunk.fetch_add(1)) < m_numChunks){
+            m_func(chunk * m_count / m_numChunks, (chunk + 1) * m_count / m_numChunks, a_worker);
+        }
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_pending--;
+        }
+        m_doneCondition.notify_all();
+    }
+}
@@ -0,0 +1,89 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Small pool of persistent threads used to split loops over voxel data.
+class WorkerPool{
+    public:
+        WorkerPool();
+        ~WorkerPool();
+
+        // a_numThreads <= 0 uses the number of hardware threads
+        void init(int a_numThreads);
+        void close();
+        int getNumThreads();
+
+        // Split [0, a_count) into contiguous ranges and run a_func(begin, end, worker) on each.
+        // Blocks until every range is done. The calling thread takes part in the work.
+        void parallelFor(int a_count, function<void(int, int, int)> a_func);
+
+    private:
+        void workerLoop(int a_worker);
+
+        vector<thread> m_threads;
+        mutex m_mutex;
+        condition_variable m_startCondition;
+        condition_variable m_doneCondition;
+
+        function<void(int, int, int)> m_func;
+        int m_count = 0;
+        int m_numChunks = 0;
+        atomic<int> m_nextChunk;
+        int m_pending = 0;
+        unsigned int m_generation = 0;
+        bool m_running = false;
+
+        // Serializes parallelFor calls coming from different threads
+        mutex m_callMutex;
+};
+
+#endif //WORKER_POOL_H
@@ -0,0 +1,210 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "network_input.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+#define TEST_PORT 57031
+
+static double getTime(){
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Pops until a_count samples came out or a_timeout passed
+static vector<SpaceNavInputSample> collect(NetworkInputReceiver& a_receiver, size_t a_count, double a_timeout){
+    vector<SpaceNavInputSample> samples;
+    double end = getTime() + a_timeout;
+    while (samples.size() < a_count && getTime() < end){
+        SpaceNavInputSample sample;
+        while (samples.size() < a_count && a_receiver.pop(sample)){
+            samples.push_back(sample);
+        }
+        usleep(200);
+    }
+    return samples;
+}
+
+// Sends packets with chosen sequence numbers, to reproduce the losses and the reordering
+static bool sendRaw(int a_socket, uint32_t a_sequence, double a_x){
+    SpaceNavPacket packet;
+    packet.m_sequence = a_sequence;
+    packet.m_sendTime = uint64_t(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+    packet.m_sample.m_axes[0] = a_x;
+    packet.m_sample.m_hasMotion = true;
+    unsigned char buffer[SPACENAV_PACKET_SIZE];
+    encodeSpaceNavPacket(packet, buffer);
+    return send(a_socket, buffer, sizeof(buffer), 0) == SPACENAV_PACKET_SIZE;
+}
+
+// Every sample sent comes out once and in order
+static bool testInOrder(NetworkInputReceiver& a_receiver){
+    NetworkInputSender sender;
+    if (!sender.open("127.0.0.1", TEST_PORT)){
+        return false;
+    }
+    for (int i = 0; i < 100; i++){
+        SpaceNavInputSample sample;
+        sample.m_axes[0] = i + 1;
+        sample.m_buttons = 1;
+        sample.m_hasMotion = true;
+        sample.m_hasButtons = true;
+        sender.send(sample);
+        usleep(500);
+    }
+
+    vector<SpaceNavInputSample> samples = collect(a_receiver, 100, 1.0);
+    if (samples.size() != 100){
+        cerr << "[ERROR] " << samples.size() << " of 100 samples received" << endl;
+        return false;
+    }
+    for (size_t i = 0; i < samples.size(); i++){
+        if (samples[i].m_axes[0] != double(i + 1) || samples[i].m_buttons != 1){
+            cerr << "[ERROR] Sample " << i << " is not the one sent" << endl;
+            return false;
+        }
+    }
+    NetworkInputStats stats = a_receiver.getStats();
+    if (stats.m_lost != 0 || stats.m_late != 0){
+        cerr << "[ERROR] " << stats.m_lost << " lost and " << stats.m_late << " late on the loopback" << endl;
+        return false;
+    }
+    return true;
+}
+
+// Once the sender is quiet for the timeout, one sample stops the motion and releases the buttons
+static bool testTimeout(NetworkInputReceiver& a_receiver, double a_timeout){
+    double start = getTime();
+    vector<SpaceNavInputSample> samples = collect(a_receiver, 1, 10.0 * a_timeout);
+    double elapsed = getTime() - start;
+    if (samples.size() != 1){
+        cerr << "[ERROR] No sample after the timeout" << endl;
+        return false;
+    }
+    const SpaceNavInputSample& sample = samples[0];
+    bool zero = sample.m_buttons == 0 && sample.m_hasMotion && sample.m_hasButtons;
+    for (int i = 0; i < 6; i++){
+        zero = zero && sample.m_axes[i] == 0.0;
+    }
+    if (!zero || a_receiver.getStats().m_timeouts != 1){
+        cerr << "[ERROR] The timeout did not stop the motion and release the buttons" << endl;
+        return false;
+    }
+    if (elapsed > 2.0 * a_timeout){
+        cerr << "[ERROR] The timeout came after " << elapsed << " s" << endl;
+        return false;
+    }
+    // Only once
+    if (!collect(a_receiver, 1, 2.0 * a_timeout).empty()){
+        cerr << "[ERROR] More than one sample after the timeout" << endl;
+        return false;
+    }
+    return true;
+}
+
+// A missing sequence number is lost, and a packet older than the last one is dropped
+static bool testGapAndReorder(NetworkInputReceiver& a_receiver){
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address;
+    address.sin_family = AF_INET;
+    address.sin_port = htons(TEST_PORT);
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (sock < 0 || connect(sock, (sockaddr*)&address, sizeof(address)) != 0){
+        cerr << "[ERROR] Could not open the raw socket" << endl;
+        return false;
+    }
+
+    // A new sequence after the timeout, with 12 missing then arriving after 13
+    NetworkInputStats before = a_receiver.getStats();
+    const uint32_t sequences[] = {1000, 1001, 1003, 1002, 1004};
+    for (uint32_t sequence: sequences){
+        sendRaw(sock, sequence, sequence);
+    }
+    close(sock);
+
+    vector<SpaceNavInputSample> samples = collect(a_receiver, 5, 0.05);
+    const double expected[] = {1000, 1001, 1003, 1004};
+    if (samples.size() != 4){
+        cerr << "[ERROR] " << samples.size() << " samples came out instead of 4" << endl;
+        return false;
+    }
+    for (size_t i = 0; i < 4; i++){
+        if (samples[i].m_axes[0] != expected[i]){
+            cerr << "[ERROR] Sample " << i << " is " << samples[i].m_axes[0] << " instead of " << expected[i] << endl;
+            return false;
+        }
+    }
+    NetworkInputStats stats = a_receiver.getStats();
+    if (stats.m_lost - before.m_lost != 1 || stats.m_late - before.m_late != 1){
+        cerr << "[ERROR] " << stats.m_lost - before.m_lost << " lost and " << stats.m_late - before.m_late
+             << " late instead of 1 and 1" << endl;
+        return false;
+    }
+    return true;
+}
+
+int main(){
+    NetworkInputParams params;
+    params.m_address = "127.0.0.1";
+    params.m_port = TEST_PORT;
+    params.m_timeout = 0.1;
+    NetworkInputReceiver receiver;
+    if (!receiver.open(params)){
+        return EXIT_FAILURE;
+    }
+
+    if (!testInOrder(receiver) || !testTimeout(receiver, params.m_timeout) || !testGapAndReorder(receiver)){
+        return EXIT_FAILURE;
+    }
+    receiver.close();
+    cout << "INFO! Network input passed" << endl;
+    return EXIT_SUCCESS;
+}
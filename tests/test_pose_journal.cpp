@@ -0,0 +1,135 @@
+//==============================================================================
+/*
+    Software License Agreement (BSD License)
+    Copyright (c) 2019-2023, AMBF
+    (https://github.com/WPI-AIM/ambf)
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following
+    disclaimer in the documentation and/or other materials provided
+    with the distribution.
+
+    * Neither the name of authors nor the names of its contributors may
+    be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+
+    \author    <hishida3@jhu.edu>
+    \author    Hisashi Ishida
+*/
+//==============================================================================
+//==============================================================================
+
+#include "pose_journal.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+static double rotationDistance(const cMatrix3d& a_rot0, const cMatrix3d& a_rot1){
+    double distance = 0.0;
+    for (int i = 0; i < 3; i++){
+        for (int j = 0; j < 3; j++){
+            distance += fabs(a_rot0(i, j) - a_rot1(i, j));
+        }
+    }
+    return distance;
+}
+
+static cMatrix3d randomRotation(mt19937& a_random){
+    normal_distribution<double> normal(0.0, 1.0);
+    cQuaternion quat(normal(a_random), normal(a_random), normal(a_random), normal(a_random));
+    quat.normalize();
+    cMatrix3d rot;
+    quat.toRotMat(rot);
+    return rot;
+}
+
+// The object is moved in two manipulations, the second is undone, and the pose set by the
+// undo is recorded back on the next ticks, as the plugin does. The redo must still be there
+static bool testUndoRedo(const cMatrix3d& a_rotA, const cMatrix3d& a_rotB, const cMatrix3d& a_rotC){
+    PoseJournal journal;
+    journal.init(4096, 16, 100.0, 0.3, 1e-5);
+    int key = 0;
+    cVector3d pos(0.1, 0.2, 0.3);
+    double time = 0.0;
+
+    journal.record(&key, pos, a_rotA, time);
+    time += 0.01;
+    journal.record(&key, pos, a_rotB, time);
+    for (int i = 0; i < 50; i++){
+        time += 0.01;
+        journal.record(&key, pos, a_rotB, time);
+    }
+    journal.record(&key, pos, a_rotC, time);
+    for (int i = 0; i < 50; i++){
+        time += 0.01;
+        journal.record(&key, pos, a_rotC, time);
+    }
+
+    cVector3d undoPos;
+    cMatrix3d undoRot;
+    if (!journal.undo(&key, time, undoPos, undoRot)){
+        cerr << "[ERROR] Nothing to undo" << endl;
+        return false;
+    }
+    if (rotationDistance(undoRot, a_rotB) > 1e-3){
+        cerr << "[ERROR] The undo did not return to the end of the first manipulation" << endl;
+        return false;
+    }
+    for (int i = 0; i < 50; i++){
+        time += 0.01;
+        journal.record(&key, undoPos, undoRot, time);
+    }
+
+    cVector3d redoPos;
+    cMatrix3d redoRot;
+    if (!journal.redo(&key, time, redoPos, redoRot)){
+        cerr << "[ERROR] The redo was dropped by the pose set by the undo" << endl;
+        return false;
+    }
+    if (rotationDistance(redoRot, a_rotC) > 1e-3 || (redoPos - pos).length() > 1e-5){
+        cerr << "[ERROR] The redo did not return to the end of the second manipulation" << endl;
+        return false;
+    }
+    return true;
+}
+
+int main(){
+    mt19937 random(42);
+    int failures = 0;
+    for (int i = 0; i < 2000; i++){
+        if (!testUndoRedo(randomRotation(random), randomRotation(random), randomRotation(random))){
+            failures++;
+        }
+    }
+    if (failures > 0){
+        cerr << "[ERROR] " << failures << " of 2000 undo and redo failed" << endl;
+        return EXIT_FAILURE;
+    }
+    cout << "INFO! Undo and redo passed" << endl;
+    return EXIT_SUCCESS;
+}